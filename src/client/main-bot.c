@@ -0,0 +1,537 @@
+/*
+ * File: main-bot.c
+ * Purpose: Headless load-generation frontend
+ *
+ * Copyright (c) 2025 MAngband and PWMAngband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "c-angband.h"
+
+#ifdef USE_BOT
+
+#include <time.h>
+#include <sys/wait.h>
+
+/*
+ * Usage: pwmangclient --bot N [--rate R] [--time T] [--host H] [--port P]
+ *
+ * Forks N headless clients logging in as Bot1 to BotN (with a random new
+ * character the first time), which then type R scripted commands per second
+ * for T seconds: walking, running, resting, casting, opening lists and
+ * chatting. Once they are all done, the keepalive round-trip times and the
+ * bytes received per second by each client are reported on stdout.
+ */
+
+
+/* Password of the bot accounts */
+#define BOT_PASS "botpass"
+
+/* Delay between two keypresses of the same command, in milliseconds */
+#define BOT_KEY_DELAY 50
+
+/* Delay between two keypresses while logging in, in milliseconds */
+#define BOT_LOGIN_DELAY 250
+
+/* Give up if the game hasn't started after this many seconds */
+#define BOT_LOGIN_TIMEOUT 60
+
+/* Delay between two logins, in milliseconds */
+#define BOT_STAGGER 100
+
+/* Most round-trip times kept per client */
+#define BOT_MAX_SAMPLES 4096
+
+
+/*
+ * Login progress
+ */
+enum
+{
+    BOT_ACCOUNT = 0,    /* Typing account name and password */
+    BOT_CHARACTER,      /* Picking (or creating) the character */
+    BOT_SPLASH,         /* Dismissing the splash screen */
+    BOT_PLAYING         /* Typing commands */
+};
+
+
+/*
+ * What a client sends back to the parent, followed by the round-trip times
+ */
+struct bot_result
+{
+    int id;
+    bool playing;               /* Did we get into the game? */
+    long bytes;                 /* Bytes received while playing */
+    long ms;                    /* Time spent playing */
+    int samples;                /* Number of round-trip times */
+    char reason[NORMAL_WID];    /* Why we quit */
+};
+
+
+/*
+ * A scripted command
+ */
+struct bot_command
+{
+    const char *keys;   /* Keys to type ('%d' is a direction, '%s' our name) */
+    int chance;         /* Relative frequency */
+};
+
+
+static const struct bot_command bot_commands[] =
+{
+    {";%d", 40},                    /* Walk */
+    {".%d", 10},                    /* Run */
+    {"R\r", 5},                     /* Rest */
+    {"maa'", 10},                   /* Cast the first spell at the nearest target */
+    {"i", 8},                       /* Inventory */
+    {"e", 8},                       /* Equipment */
+    {"C", 4},                       /* Character sheet */
+    {"[", 5},                       /* Monster list */
+    {":Hello from %s!\r", 10}       /* Chat */
+};
+
+
+static term bot_term;
+static int bot_id;
+static int bot_out = -1;
+static int32_t bot_rate = 4;
+static int32_t bot_time = 60;
+static int bot_phase;
+static char bot_name[NORMAL_WID];
+static char bot_keys[NORMAL_WID];
+static size_t bot_key;
+static long bot_begin, bot_next, bot_start, bot_bytes;
+static long bot_rtt[BOT_MAX_SAMPLES];
+static int bot_samples;
+
+
+/*
+ * Current time in milliseconds, from a clock that never jumps or wraps
+ */
+static long bot_ms(void)
+{
+    struct timespec cur_time;
+
+    clock_gettime(CLOCK_MONOTONIC, &cur_time);
+    return (long)cur_time.tv_sec * 1000 + cur_time.tv_nsec / 1000000;
+}
+
+
+/*
+ * Record the round-trip time of a keepalive
+ */
+static void bot_keepalive(long ms)
+{
+    if ((bot_phase == BOT_PLAYING) && (bot_samples < BOT_MAX_SAMPLES))
+        bot_rtt[bot_samples++] = ms;
+}
+
+
+/*
+ * Pick a scripted command and prepare its keys
+ */
+static void bot_command(void)
+{
+    int total = 0, roll;
+    size_t i;
+    const char *keys;
+
+    for (i = 0; i < N_ELEMENTS(bot_commands); i++) total += bot_commands[i].chance;
+    roll = randint0(total);
+    for (i = 0; roll >= bot_commands[i].chance; i++) roll -= bot_commands[i].chance;
+    keys = bot_commands[i].keys;
+
+    /* Fill in a random direction or our name */
+    if (strstr(keys, "%d"))
+        strnfmt(bot_keys, sizeof(bot_keys), keys, "12346789"[randint0(8)] - '0');
+    else if (strstr(keys, "%s"))
+        strnfmt(bot_keys, sizeof(bot_keys), keys, bot_name);
+    else
+        my_strcpy(bot_keys, keys, sizeof(bot_keys));
+
+    /* Back out of any prompt or list */
+    my_strcat(bot_keys, "\033\033", sizeof(bot_keys));
+    bot_key = 0;
+}
+
+
+/*
+ * Type the next key, if it is time to
+ */
+static bool bot_type(void)
+{
+    long now = bot_ms();
+    char ch;
+
+    if (now < bot_next) return false;
+
+    /* Advance the script */
+    if (!bot_keys[bot_key])
+    {
+        switch (bot_phase)
+        {
+            case BOT_ACCOUNT:
+            {
+                /* Wait for the server to list our characters */
+                if (Net_fd() == -1) break;
+
+                /* Don't make all bots alike */
+                Rand_state_init(time(NULL) + bot_id * 7919);
+
+                /* Pick the first character, or create a random one */
+                my_strcpy(bot_keys, (char_num? "a": "a\r@ "), sizeof(bot_keys));
+                bot_key = 0;
+                bot_phase = BOT_CHARACTER;
+                break;
+            }
+
+            case BOT_CHARACTER:
+            {
+                /* Wait for the server to send the game data */
+                if (Setup.initialized) bot_phase = BOT_SPLASH;
+                break;
+            }
+
+            case BOT_SPLASH:
+            {
+                /* Keep dismissing the splash screen until it is gone */
+                if (!Setup.ready)
+                {
+                    my_strcpy(bot_keys, " ", sizeof(bot_keys));
+                    bot_key = 0;
+                    break;
+                }
+
+                /* Start playing */
+                bot_phase = BOT_PLAYING;
+                bot_start = now;
+                bot_bytes = Net_received();
+                bot_next = now + 1000 / bot_rate;
+                return false;
+            }
+
+            case BOT_PLAYING:
+            {
+                /* Done */
+                if (now - bot_start >= bot_time * 1000L) quit(NULL);
+
+                bot_command();
+                break;
+            }
+        }
+
+        /* Don't hang forever on the login screens */
+        if ((bot_phase != BOT_PLAYING) && (now - bot_begin >= BOT_LOGIN_TIMEOUT * 1000L))
+            quit("Timed out while logging in");
+
+        if (!bot_keys[bot_key]) return false;
+    }
+
+    /* Type the key */
+    ch = bot_keys[bot_key++];
+    if (ch == '\r') Term_keypress(KC_ENTER, 0);
+    else if (ch == '\033') Term_keypress(ESCAPE, 0);
+    else Term_keypress((keycode_t)ch, 0);
+
+    /* Wait for the next one */
+    if (bot_phase == BOT_SPLASH) bot_next = now + 1000;
+    else if (bot_phase != BOT_PLAYING) bot_next = now + BOT_LOGIN_DELAY;
+    else if (bot_keys[bot_key]) bot_next = now + BOT_KEY_DELAY;
+    else bot_next = now + 1000 / bot_rate;
+
+    return true;
+}
+
+
+/*
+ * Handle a "special request"
+ */
+static errr Term_xtra_bot(int n, int v)
+{
+    switch (n)
+    {
+        /* Process events */
+        case TERM_XTRA_EVENT:
+        {
+            if (bot_type()) return 0;
+
+            /* Don't spin while waiting */
+            if (v)
+            {
+                Sleep(10);
+                return 1;
+            }
+            return 0;
+        }
+
+        /* Flush events */
+        case TERM_XTRA_FLUSH: return 0;
+
+        /* Delay */
+        case TERM_XTRA_DELAY: if (v > 0) Sleep(v); return 0;
+
+        /* Nothing to display */
+        case TERM_XTRA_CLEAR:
+        case TERM_XTRA_FRESH:
+        case TERM_XTRA_SHAPE:
+        case TERM_XTRA_REACT: return 0;
+    }
+
+    /* Unknown event */
+    return 1;
+}
+
+
+static errr Term_curs_bot(int x, int y)
+{
+    return 0;
+}
+
+
+static errr Term_wipe_bot(int x, int y, int n)
+{
+    return 0;
+}
+
+
+static errr Term_text_bot(int x, int y, int n, uint16_t a, const char *s)
+{
+    return 0;
+}
+
+
+/*
+ * Send our results to the parent and shut down
+ */
+static void hook_quit(const char *str)
+{
+    static bool quitting = false;
+    struct bot_result res;
+
+    /* Don't re-enter if already quitting */
+    if (quitting) return;
+    quitting = true;
+
+    memset(&res, 0, sizeof(res));
+    res.id = bot_id;
+    res.playing = (bot_phase == BOT_PLAYING);
+    if (res.playing)
+    {
+        res.bytes = Net_received() - bot_bytes;
+        res.ms = bot_ms() - bot_start;
+        res.samples = bot_samples;
+    }
+    my_strcpy(res.reason, ((str && *str)? str: "Done"), sizeof(res.reason));
+
+    /* The parent reads the pipe to the end, so this won't fail */
+    if ((write(bot_out, &res, sizeof(res)) != sizeof(res)) ||
+        (write(bot_out, bot_rtt, res.samples * sizeof(long)) != (ssize_t)(res.samples * sizeof(long))))
+    {
+        plog("Couldn't report the bot results");
+    }
+    close(bot_out);
+
+    term_nuke(&bot_term);
+
+    /* Free resources */
+    textui_cleanup();
+    cleanup_angband();
+    close_sound();
+
+    /* Cleanup network stuff */
+    Net_cleanup();
+}
+
+
+/*
+ * Sort round-trip times
+ */
+static int cmp_rtt(const void *a, const void *b)
+{
+    long x = *(const long *)a, y = *(const long *)b;
+
+    return ((x > y) - (x < y));
+}
+
+
+/*
+ * Percentile of sorted round-trip times
+ */
+static long percentile(long *rtt, int count, int pct)
+{
+    if (!count) return 0;
+    return rtt[(count - 1) * pct / 100];
+}
+
+
+/*
+ * Print a report line
+ */
+static void bot_print(const char *name, const char *status, long *rtt, int count, double rate)
+{
+    sort(rtt, count, sizeof(long), cmp_rtt);
+    printf("%-8s %-9s %7d %6ld %6ld %6ld %6ld %10.0f\n", name, status, count,
+        percentile(rtt, count, 50), percentile(rtt, count, 90), percentile(rtt, count, 99),
+        percentile(rtt, count, 100), rate);
+}
+
+
+/*
+ * Collect the results of all bots and print the report
+ */
+static void bot_report(int *pipes, int bots)
+{
+    long *all = NULL;
+    int total = 0, playing = 0, i;
+    double bytes = 0;
+
+    printf("%-8s %-9s %7s %6s %6s %6s %6s %10s\n", "Client", "Status", "Samples", "p50", "p90",
+        "p99", "max", "Bytes/s");
+
+    for (i = 0; i < bots; i++)
+    {
+        struct bot_result res;
+        long *rtt = NULL;
+        char name[NORMAL_WID];
+        double rate = 0;
+
+        strnfmt(name, sizeof(name), "Bot%d", i + 1);
+
+        /* Read everything the bot sent */
+        if (read(pipes[i], &res, sizeof(res)) != sizeof(res))
+        {
+            bot_print(name, "crashed", NULL, 0, 0);
+            close(pipes[i]);
+            continue;
+        }
+        if (res.samples > 0)
+        {
+            rtt = mem_alloc(res.samples * sizeof(long));
+            if (read(pipes[i], rtt, res.samples * sizeof(long)) != (ssize_t)(res.samples * sizeof(long)))
+                res.samples = 0;
+        }
+        close(pipes[i]);
+
+        if (res.playing && (res.ms > 0))
+        {
+            rate = res.bytes * 1000.0 / res.ms;
+            bytes += rate;
+            playing++;
+        }
+        bot_print(name, (res.playing? "played": "failed"), rtt, res.samples, rate);
+        if (!res.playing || strcmp(res.reason, "Done")) printf("         (%s)\n", res.reason);
+
+        /* Pool the round-trip times */
+        if (res.samples > 0)
+        {
+            all = mem_realloc(all, (total + res.samples) * sizeof(long));
+            memcpy(all + total, rtt, res.samples * sizeof(long));
+            total += res.samples;
+        }
+        mem_free(rtt);
+    }
+
+    printf("\n%d of %d clients played, %.0f bytes/s received in total.\n", playing, bots, bytes);
+    bot_print("All", "", all, total, (playing? bytes / playing: 0));
+    mem_free(all);
+}
+
+
+/*
+ * Start the bots
+ *
+ * The parent forks one child per bot and waits for their results; the
+ * children carry on as headless clients.
+ */
+errr init_bot(int argc, char **argv)
+{
+    int32_t bots = 0;
+    int *pipes;
+    int i;
+
+    /* Only when asked for */
+    if (!clia_read_int(&bots, "bot")) return (1);
+    if (bots <= 0) quit("Usage: --bot <number of clients> [--rate <commands/s>] [--time <seconds>]");
+    clia_read_int(&bot_rate, "rate");
+    clia_read_int(&bot_time, "time");
+    if (bot_rate <= 0) bot_rate = 1;
+    if (bot_rate > 1000 / BOT_KEY_DELAY) bot_rate = 1000 / BOT_KEY_DELAY;
+
+    pipes = mem_zalloc(bots * sizeof(int));
+    for (i = 0; i < bots; i++)
+    {
+        int fd[2];
+        pid_t pid;
+
+        if (pipe(fd) == -1) quit("Couldn't create a pipe for the bots");
+        pid = fork();
+        if (pid == -1) quit("Couldn't start the bots");
+
+        /* Child: become a bot */
+        if (pid == 0)
+        {
+            int j;
+
+            for (j = 0; j < i; j++) close(pipes[j]);
+            mem_free(pipes);
+            close(fd[0]);
+            bot_out = fd[1];
+            bot_id = i + 1;
+            break;
+        }
+
+        close(fd[1]);
+        pipes[i] = fd[0];
+
+        /* Don't log everyone in at once */
+        Sleep(BOT_STAGGER);
+    }
+
+    /* Parent: report and leave */
+    if (i == bots)
+    {
+        bot_report(pipes, bots);
+        while (wait(NULL) > 0) ;
+        mem_free(pipes);
+        exit(0);
+    }
+
+    /* Activate hooks */
+    quit_aux = hook_quit;
+    keepalive_hook = bot_keepalive;
+
+    /* The account name and password are typed like a player would */
+    strnfmt(bot_name, sizeof(bot_name), "Bot%d", bot_id);
+    strnfmt(bot_keys, sizeof(bot_keys), "%s\r%s\r", bot_name, BOT_PASS);
+    bot_begin = bot_ms();
+
+    /* Create a term that displays nothing */
+    term_init(&bot_term, NORMAL_WID, NORMAL_HGT, NORMAL_HGT, 256);
+    bot_term.complex_input = true;
+    bot_term.text_hook = Term_text_bot;
+    bot_term.wipe_hook = Term_wipe_bot;
+    bot_term.curs_hook = Term_curs_bot;
+    bot_term.xtra_hook = Term_xtra_bot;
+    Term_activate(&bot_term);
+
+    /* Remember the active screen */
+    angband_term[0] = &bot_term;
+    term_screen = &bot_term;
+
+    /* Success */
+    return (0);
+}
+
+#endif /* USE_BOT */
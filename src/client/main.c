@@ -40,6 +40,10 @@ static errr init_error(int argc, char **argv)
  */
 static const struct module modules[] =
 {
+#ifdef USE_BOT
+    {"bot", init_bot},
+#endif
+
 #ifdef USE_SDL
     {"sdl", init_sdl},
 #endif
@@ -21,5 +21,8 @@ extern errr init_sdl2(int argc, char **argv);
 #ifdef USE_GCU
 extern errr init_gcu(int argc, char **argv);
 #endif
+#ifdef USE_BOT
+extern errr init_bot(int argc, char **argv);
+#endif
 
 #endif /* INCLUDED_MAIN_H */
@@ -70,10 +70,28 @@ int *party_y = NULL;
 static int conn_state;
 
 
+/* Capabilities agreed with the server */
+uint32_t server_caps = 0L;
+
+
 /* Keeps track of time in 100ms "ticks" */
 static int ticks = 0, last_sent = 0, last_received = 0;
 
 
+/* Called with the round-trip time of each keepalive, in milliseconds */
+void (*keepalive_hook)(long ms) = NULL;
+
+
+/* Send times of the keepalives still waiting for their echo */
+#define KEEPALIVE_PENDING 8
+static struct
+{
+    int tick;
+    long ms;
+} keepalive_pending[KEEPALIVE_PENDING];
+static int keepalive_next;
+
+
 static bool request_redraw;
 static sockbuf_t rbuf, wbuf, qbuf;
 static char talk_pend[MSG_LEN], initialized = 0;
@@ -82,6 +100,25 @@ static bool dump_only = false;
 static uint8_t chardump = 0;
 
 
+/*
+ * Struct info cache
+ *
+ * Servers supporting CAPS_STRUCT_CACHE send a digest of their struct info in the contact reply.
+ * Struct info packets received during each setup phase are recorded, and saved to disk once
+ * they match that digest. On the next connection with the same digest, we tell the server not
+ * to send them and replay the saved packets instead.
+ */
+static char struct_hash[33];
+static bool struct_cached;
+static int struct_phase;
+static int struct_pending;
+static struct
+{
+    char *buf;
+    int len;
+} struct_data[STRUCT_INFO_PHASES];
+
+
 /* Packet types */
 static int cur_type = 0;
 static int prev_type = 0;
@@ -153,7 +190,24 @@ static void update_ticks(void)
 
     /* Wrap every day */
     if ((ticks < last_sent) || (ticks < last_received))
+    {
         last_sent = last_received = 0;
+        memset(keepalive_pending, 0, sizeof(keepalive_pending));
+    }
+}
+
+
+/* Current time in milliseconds, for measuring round trips */
+static long get_ms(void)
+{
+#ifdef WINDOWS
+    return (long)timeGetTime();
+#else
+    struct timeval cur_time;
+
+    gettimeofday(&cur_time, NULL);
+    return (long)(cur_time.tv_sec % 86400) * 1000 + cur_time.tv_usec / 1000;
+#endif
 }
 
 
@@ -172,6 +226,12 @@ void do_keepalive(void)
             player->upkeep->redraw |= (PR_LAG);
         }
         last_sent = ticks;
+        if (keepalive_hook)
+        {
+            keepalive_pending[keepalive_next].tick = last_sent;
+            keepalive_pending[keepalive_next].ms = get_ms();
+            keepalive_next = (keepalive_next + 1) % KEEPALIVE_PENDING;
+        }
         Send_keepalive();
     }
 }
@@ -276,6 +336,159 @@ void loading_screen(int pct)
 }
 
 
+static void struct_cache_free(void)
+{
+    int i;
+
+    for (i = 0; i < STRUCT_INFO_PHASES; i++)
+    {
+        mem_free(struct_data[i].buf);
+        struct_data[i].buf = NULL;
+        struct_data[i].len = 0;
+    }
+}
+
+
+static bool struct_cache_valid(void)
+{
+    char *bufs[STRUCT_INFO_PHASES];
+    int lens[STRUCT_INFO_PHASES];
+    char hash[33];
+    int i;
+
+    for (i = 0; i < STRUCT_INFO_PHASES; i++)
+    {
+        if (!struct_data[i].len) return false;
+        bufs[i] = struct_data[i].buf;
+        lens[i] = struct_data[i].len;
+    }
+    MD5Digest(hash, bufs, lens, STRUCT_INFO_PHASES);
+
+    return streq(hash, struct_hash);
+}
+
+
+/*
+ * Look for struct info matching the digest sent by the server in the cache file
+ */
+void struct_cache_load(const char *hash)
+{
+    char path[MSG_LEN];
+    char buf[33];
+    ang_file *f;
+    int i, j;
+
+    struct_cache_free();
+    struct_cached = false;
+    struct_pending = 0;
+    my_strcpy(struct_hash, hash, sizeof(struct_hash));
+    if (!struct_hash[0]) return;
+
+    path_build(path, sizeof(path), ANGBAND_DIR_USER, "struct.cache");
+    f = file_open(path, MODE_READ, FTYPE_RAW);
+    if (!f) return;
+
+    /* Data from another server (or another version of it) */
+    if ((file_read(f, buf, 32) != 32) || strncmp(buf, struct_hash, 32))
+    {
+        file_close(f);
+        return;
+    }
+
+    for (i = 0; i < STRUCT_INFO_PHASES; i++)
+    {
+        int len = 0;
+
+        for (j = 0; j < 4; j++)
+        {
+            uint8_t b;
+
+            if (!file_readc(f, &b)) break;
+            len = (len << 8) | b;
+        }
+        if ((j < 4) || (len <= 0) || (len > CLIENT_RECV_SIZE)) break;
+
+        struct_data[i].buf = mem_alloc(len);
+        struct_data[i].len = len;
+        if (file_read(f, struct_data[i].buf, len) != (size_t)len) break;
+    }
+    file_close(f);
+
+    /* Only trust what hashes right */
+    struct_cached = ((i == STRUCT_INFO_PHASES) && struct_cache_valid());
+    if (!struct_cached) struct_cache_free();
+}
+
+
+/*
+ * Save the struct info received from the server, if complete
+ */
+static void struct_cache_save(void)
+{
+    char path[MSG_LEN];
+    ang_file *f;
+    int i, j;
+
+    if (!struct_cached && struct_hash[0] && struct_cache_valid())
+    {
+        path_build(path, sizeof(path), ANGBAND_DIR_USER, "struct.cache");
+        f = file_open(path, MODE_WRITE, FTYPE_RAW);
+        if (f)
+        {
+            file_write(f, struct_hash, 32);
+            for (i = 0; i < STRUCT_INFO_PHASES; i++)
+            {
+                for (j = 3; j >= 0; j--) file_writec(f, (uint8_t)(struct_data[i].len >> (j * 8)));
+                file_write(f, struct_data[i].buf, struct_data[i].len);
+            }
+            file_close(f);
+        }
+    }
+
+    /* Done with the struct info */
+    struct_hash[0] = '\0';
+    struct_cached = false;
+    struct_cache_free();
+}
+
+
+/*
+ * Record a struct info packet for the cache
+ */
+static void struct_cache_record(int phase, const char *buf, int len)
+{
+    if (struct_cached || !struct_hash[0] || (phase < 1) || (phase > STRUCT_INFO_PHASES)) return;
+
+    phase--;
+    struct_data[phase].buf = mem_realloc(struct_data[phase].buf, struct_data[phase].len + len);
+    memcpy(struct_data[phase].buf + struct_data[phase].len, buf, len);
+    struct_data[phase].len += len;
+}
+
+
+/*
+ * Feed the cached struct info of the phases requested so far to the packet handlers
+ */
+static int struct_cache_replay(void)
+{
+    sockbuf_t saved = rbuf;
+    int phase, n = 0;
+
+    while (struct_pending && (n != -1))
+    {
+        phase = struct_pending - 1;
+        struct_pending = 0;
+
+        rbuf.buf = rbuf.ptr = struct_data[phase].buf;
+        rbuf.len = rbuf.size = struct_data[phase].len;
+        n = Net_packet();
+    }
+
+    rbuf = saved;
+    return n;
+}
+
+
 /*** Receiving ***/
 
 
@@ -342,6 +555,8 @@ static int Receive_struct_info(void)
     uint16_t max;
     char name[NORMAL_WID];
     int bytes_read;
+    char *start = rbuf.ptr;
+    int phase = struct_phase;
 
     typ = max = 0;
 
@@ -1288,7 +1503,8 @@ static int Receive_struct_info(void)
                 }
             }
 
-            Send_play(chardump? 3: 2);
+            /* Character dumps skip the feat info, unless it is needed to complete the cache */
+            Send_play((chardump && (struct_cached || !struct_hash[0]))? 3: 2);
 
             break;
         }
@@ -1481,6 +1697,8 @@ static int Receive_struct_info(void)
         }
     }
 
+    struct_cache_record(phase, start, rbuf.ptr - start);
+
     return 1;
 }
 
@@ -2432,6 +2650,117 @@ static int Receive_line_info(void)
 }
 
 
+/*
+ * Draw a grid of the main map, or queue it for later if the map is covered
+ */
+static void draw_map_char(uint8_t x, uint8_t y, uint16_t a, char c, uint16_t tap, char tcp)
+{
+    uint8_t x_off = x + COL_MAP;
+    bool draw = true;
+    int n;
+
+    if (player->screen_save_depth || section_icky_row || store_ctx) draw = false;
+    if (section_icky_row)
+    {
+        if (y >= section_icky_row) draw = true;
+        else if ((section_icky_col > 0) && (x_off >= section_icky_col)) draw = true;
+        else if ((section_icky_col < 0) && (x_off >= 0 - section_icky_col)) draw = true;
+    }
+
+    if (draw)
+    {
+        x_off += x * (tile_width - 1);
+        y = (y - 1) * tile_height + 1;
+
+        Term_queue_char_safe(x_off, y, a, c, tap, tcp);
+        if (tile_width * tile_height > 1)
+        {
+            uint16_t a_dummy = (use_graphics? COLOUR_WHITE: 0);
+            char c_dummy = (use_graphics? ' ': 0);
+
+            Term_big_queue_char_safe(x_off, y, a, c, a_dummy, c_dummy);
+        }
+    }
+
+    /* Queue for later */
+    else
+    {
+        n = Packet_printf(&qbuf, "%b%b%b%hu%c", (unsigned)PKT_CHAR, (unsigned)x,
+            (unsigned)y, (unsigned)a, (int)c);
+        if ((n > 0) && use_graphics)
+            Packet_printf(&qbuf, "%hu%c", (unsigned)tap, (int)tcp);
+    }
+}
+
+
+/*
+ * Receive the spans of grids of a row of the map that changed since the client got it
+ */
+static int Receive_line_delta(void)
+{
+    uint8_t ch, spans, i;
+    uint8_t x[128], num[128];
+    int16_t y = 0;
+    int n, k, bytes_read;
+    cave_view_type *dest, *trn;
+
+    if ((n = Packet_scanf(&rbuf, "%b%hd%b", &ch, &y, &spans)) <= 0) return n;
+    bytes_read = 4;
+
+    /* Paranoia */
+    if ((y < 0) || (y >= Setup.max_row + ROW_MAP + 1) || (spans > N_ELEMENTS(x)))
+    {
+        errno = 0;
+        plog_fmt("Received bad map row (%d, %d)", y, spans);
+        return -1;
+    }
+
+    dest = player->scr_info[y];
+    trn = player->trn_info[y];
+
+    for (i = 0; i < spans; i++)
+    {
+        if ((n = Packet_scanf(&rbuf, "%b%b", &x[i], &num[i])) <= 0)
+        {
+            /* Rollback the socket buffer */
+            Sockbuf_rollback(&rbuf, bytes_read);
+
+            /* Packet isn't complete, graceful failure */
+            return n;
+        }
+        bytes_read += 2;
+
+        /* Paranoia */
+        if (x[i] + num[i] > Setup.max_col + COL_MAP)
+        {
+            errno = 0;
+            plog_fmt("Received bad map span (%d, %d)", x[i], num[i]);
+            return -1;
+        }
+
+        /* Decode the secondary attr/char stream */
+        if (use_graphics)
+        {
+            n = rle_decode(&rbuf, trn + x[i], num[i], RLE_NONE, &bytes_read);
+            if (n <= 0) return n;
+        }
+
+        /* Decode the attr/char stream */
+        n = rle_decode(&rbuf, dest + x[i], num[i], RLE_NONE, &bytes_read);
+        if (n <= 0) return n;
+    }
+
+    /* Put data to screen */
+    for (i = 0; i < spans; i++)
+    {
+        for (k = x[i]; k < x[i] + num[i]; k++)
+            draw_map_char((uint8_t)k, (uint8_t)y, dest[k].a, dest[k].c, trn[k].a, trn[k].c);
+    }
+
+    return 1;
+}
+
+
 static int Receive_speed(void)
 {
     int n;
@@ -2513,10 +2842,9 @@ static int Receive_char(void)
 {
     int n;
     uint8_t ch;
-    uint8_t x, y, x_off;
+    uint8_t x, y;
     char c, tcp;
     uint16_t a, tap;
-    bool draw = true;
     int bytes_read;
 
     tap = tcp = c = a = x = y = 0;
@@ -2560,40 +2888,7 @@ static int Receive_char(void)
         player->trn_info[y][x].c = tcp;
     }
 
-    /* Hack -- manipulate offset */
-    x_off = x + COL_MAP;
-
-    if (player->screen_save_depth || section_icky_row || store_ctx) draw = false;
-    if (section_icky_row)
-    {
-        if (y >= section_icky_row) draw = true;
-        else if ((section_icky_col > 0) && (x_off >= section_icky_col)) draw = true;
-        else if ((section_icky_col < 0) && (x_off >= 0 - section_icky_col)) draw = true;
-    }
-
-    if (draw)
-    {
-        x_off += x * (tile_width - 1);
-        y = (y - 1) * tile_height + 1;
-
-        Term_queue_char_safe(x_off, y, a, c, tap, tcp);
-        if (tile_width * tile_height > 1)
-        {
-            uint16_t a_dummy = (use_graphics? COLOUR_WHITE: 0);
-            char c_dummy = (use_graphics? ' ': 0);
-
-            Term_big_queue_char_safe(x_off, y, a, c, a_dummy, c_dummy);
-        }
-    }
-
-    /* Queue for later */
-    else
-    {
-        n = Packet_printf(&qbuf, "%b%b%b%hu%c", (unsigned)ch, (unsigned)x,
-            (unsigned)y, (unsigned)a, (int)c);
-        if ((n > 0) && use_graphics)
-            Packet_printf(&qbuf, "%hu%c", (unsigned)tap, (int)tcp);
-    }
+    draw_map_char(x, y, a, c, tap, tcp);
 
     return 1;
 }
@@ -3504,7 +3799,7 @@ static int Receive_features(void)
 
 static int Receive_text_screen(void)
 {
-    int n, i;
+    int n;
     uint8_t ch;
     int16_t type;
     int32_t off, len;
@@ -3516,17 +3811,22 @@ static int Receive_text_screen(void)
         return n;
     bytes_read = 11;
 
-    for (i = 0; i < len; i++)
+    /* Paranoia */
+    if ((type < 0) || (type >= MAX_TEXTFILES) || (off < 0) || (len < 0) ||
+        (off + len > TEXTFILE__WID * TEXTFILE__HGT))
     {
-        if ((n = Packet_scanf(&rbuf, "%c", &Setup.text_screen[type][off + i])) <= 0)
-        {
-            /* Rollback the socket buffer */
-            Sockbuf_rollback(&rbuf, bytes_read);
+        errno = 0;
+        plog_fmt("Received bad text screen chunk (%d, %ld, %ld)", type, (long)off, (long)len);
+        return -1;
+    }
 
-            /* Packet isn't complete, graceful failure */
-            return n;
-        }
-        bytes_read += 1;
+    if ((n = Packet_read_bytes(&rbuf, &Setup.text_screen[type][off], len)) < len)
+    {
+        /* Rollback the socket buffer */
+        Sockbuf_rollback(&rbuf, bytes_read);
+
+        /* Packet isn't complete, graceful failure */
+        return n;
     }
 
     if (len == 0)
@@ -3566,7 +3866,7 @@ static int Receive_text_screen(void)
     else
     {
         /* Request continuation */
-        Send_text_screen(type, off + i);
+        Send_text_screen(type, off + len);
     }
 
     return 1;
@@ -3595,6 +3895,29 @@ static int Receive_keepalive(void)
         player->upkeep->redraw |= (PR_LAG);
     }
 
+    /* Report the exact round trip, even if a later keepalive was sent meanwhile */
+    if (keepalive_hook && ctime && (conn_state == CONN_PLAYING))
+    {
+        int i;
+
+        for (i = 0; i < KEEPALIVE_PENDING; i++)
+        {
+            long ms;
+
+            if (keepalive_pending[i].tick != ctime) continue;
+
+            ms = get_ms() - keepalive_pending[i].ms;
+
+            /* Wrap every day */
+            if (ms < 0) ms += 86400L * 1000;
+            keepalive_hook(ms);
+
+            /* Each echo is only counted once */
+            keepalive_pending[i].tick = 0;
+            break;
+        }
+    }
+
     return 1;
 }
 
@@ -3612,6 +3935,9 @@ static int Receive_char_info_conn(void)
     if ((n = Packet_scanf(&rbuf, "%b%b%b%b%b", &ch, &mode, &ridx, &cidx, &psex)) <= 0)
         return n;
 
+    /* This follows the last struct info phase, whatever the login mode */
+    struct_cache_save();
+
     if (dump_only) return 1;
 
     /* No character */
@@ -4709,7 +5035,7 @@ int Send_walk(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_WALK, dir)) <= 0)
+    if ((n = Packet_write_walk(&wbuf, dir)) <= 0)
         return n;
 
     return 1;
@@ -4724,7 +5050,7 @@ int Send_run(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_RUN, dir)) <= 0)
+    if ((n = Packet_write_run(&wbuf, dir)) <= 0)
         return n;
 
     return 1;
@@ -4740,7 +5066,7 @@ int Send_tunnel(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c%b", (unsigned)PKT_TUNNEL, dir, (unsigned)starting)) <= 0)
+    if ((n = Packet_write_tunnel(&wbuf, dir, (unsigned)starting)) <= 0)
         return n;
 
     return 1;
@@ -5511,7 +5837,7 @@ int Send_rest(int16_t resting)
 {
     int n;
 
-    if ((n = Packet_printf(&wbuf, "%b%hd", (unsigned)PKT_REST, (int)resting)) <= 0)
+    if ((n = Packet_write_rest(&wbuf, (int)resting)) <= 0)
         return n;
 
     return 1;
@@ -5632,7 +5958,7 @@ int Send_alter(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_ALTER, dir)) <= 0)
+    if ((n = Packet_write_alter(&wbuf, dir)) <= 0)
         return n;
 
     return 1;
@@ -5845,6 +6171,13 @@ int Send_play(int phase)
     n = Packet_printf(&wbuf, "%b%b", (unsigned)PKT_PLAY, (unsigned)phase);
     if (n <= 0) return n;
 
+    /* Struct info phases */
+    if ((phase >= 1) && (phase <= STRUCT_INFO_PHASES))
+    {
+        struct_phase = phase;
+        if (struct_cached) struct_pending = phase;
+    }
+
     /* Send nick/pass */
     if (phase == 0)
     {
@@ -5856,6 +6189,13 @@ int Send_play(int phase)
         n = Packet_printf(&wbuf, "%s%s", nick, stored_pass);
         if (n <= 0) return n;
 
+        /* Tell the server whether it can skip the struct info */
+        if (server_caps & CAPS_STRUCT_CACHE)
+        {
+            n = Packet_printf(&wbuf, "%b", (unsigned)struct_cached);
+            if (n <= 0) return n;
+        }
+
         if (nick[pos - 1] == '=') nick[pos - 1] = '\0';
         else if (nick[pos - 1] == '-') nick[pos - 1] = '\0';
         else if (nick[pos - 1] == '+')
@@ -5887,7 +6227,7 @@ int Send_keepalive(void)
 {
     int n;
 
-    if ((n = Packet_printf(&wbuf, "%b%ld", (unsigned)PKT_KEEPALIVE, last_sent)) <= 0)
+    if ((n = Packet_write_keepalive(&wbuf, last_sent)) <= 0)
         return n;
 
     return 1;
@@ -6477,6 +6817,10 @@ int Net_init(int fd)
         return -1;
     }
 
+    /* The server deflates everything it sends from now on */
+    if ((server_caps & CAPS_COMPRESS) && (Sockbuf_decompress(&rbuf) == -1))
+        return -1;
+
     /* Write buffer */
     if (Sockbuf_init(&wbuf, sock, CLIENT_SEND_SIZE, SOCKBUF_WRITE) == -1)
     {
@@ -6557,6 +6901,15 @@ int Net_fd(void)
 }
 
 
+/*
+ * Return the number of bytes received from the server so far.
+ */
+long Net_received(void)
+{
+    return rbuf.nread;
+}
+
+
 /*
  * Read packets from the net until there are no more available.
  */
@@ -6567,8 +6920,8 @@ int Net_input(void)
 
     netfd = Net_fd();
 
-    /* Keep reading as long as we have something on the socket */
-    while (SocketReadable(netfd))
+    /* Keep reading as long as we have something on the socket (or left to inflate) */
+    while (Sockbuf_backlog(&rbuf) || SocketReadable(netfd))
     {
         n = Sockbuf_read(&rbuf);
         if (n == 0) quit("Server closed the connection");
@@ -6580,6 +6933,9 @@ int Net_input(void)
             /* Make room for more packets */
             Sockbuf_advance(&rbuf, rbuf.ptr - rbuf.buf);
 
+            /* Struct info we didn't ask the server for */
+            if ((n != -1) && struct_pending) n = struct_cache_replay();
+
             if (n == -1) return -1;
         }
     }
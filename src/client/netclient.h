@@ -4,6 +4,7 @@
  */
 
 extern bool send_quit;
+extern uint32_t server_caps;
 extern struct angband_constants z_info_struct;
 extern uint16_t flavor_max;
 extern uint16_t preset_max;
@@ -15,6 +16,7 @@ extern int cursor_y;
 extern int party_n;
 extern int *party_x;
 extern int *party_y;
+extern void (*keepalive_hook)(long ms);
 
 /*** Utilities ***/
 extern int Flush_queue(void);
@@ -22,6 +24,7 @@ extern void do_keepalive(void);
 extern void check_term_resize(bool main_win, int *cols, int *rows);
 extern void net_term_resize(int cols, int rows, int max_rows);
 extern void loading_screen(int pct);
+extern void struct_cache_load(const char *hash);
 
 /*** Sending ***/
 extern int Send_features(int lighting, int off);
@@ -128,6 +131,7 @@ extern void Net_cleanup(void);
 extern int Net_flush(void);
 extern int Net_fd(void);
 extern int Net_input(void);
+extern long Net_received(void);
 extern bool Net_Send(int Socket, sockbuf_t* ibuf);
 extern bool Net_WaitReply(int Socket, sockbuf_t* ibuf, int retries);
 
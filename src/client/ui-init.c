@@ -668,6 +668,7 @@ void client_init(bool new_game, int argc, char **argv)
     Packet_printf(&ibuf, "%hu", (unsigned)conntype);
     Packet_printf(&ibuf, "%hu%c", (unsigned)current_version(), (int)beta_version());
     Packet_printf(&ibuf, "%s%s%s%s", real_name, host_name, nick, stored_pass);
+    Packet_printf(&ibuf, "%lu", (uint32_t)CAPS_SUPPORTED);
 
     /* Send it */
     if (!Net_Send(Socket, &ibuf))
@@ -747,6 +748,16 @@ void client_init(bool new_game, int argc, char **argv)
         }
     }
 
+    /* Newer servers tell us which capabilities they accepted */
+    server_caps = 0L;
+    if (ibuf.len - (ibuf.ptr - ibuf.buf) >= 4)
+        Packet_scanf(&ibuf, "%lu", &server_caps);
+
+    /* Check if we already have the struct info of this server */
+    buffer[0] = '\0';
+    if (server_caps & CAPS_STRUCT_CACHE) Packet_scanf(&ibuf, "%s", buffer);
+    struct_cache_load(buffer);
+
     /* Server agreed to talk, initialize the buffers */
     if (Net_init(Socket) == -1)
         quit("Network initialization failed!");
@@ -12,3 +12,5 @@ MFLAG(AWARE, "Monster is aware of the player")                      /* monster P
 MFLAG(HANDLED, "Monster has been processed this turn")              /* monster PoV */
 MFLAG(TRACKING, "Monster is tracking the player by sound or scent") /* monster PoV */
 MFLAG(HURT, "Monster is hurt")                                      /* player PoV */
+MFLAG(WOUNDED, "Monster is on the list of wounded monsters")        /* monster PoV */
+MFLAG(TIMED, "Monster has timed effects")                           /* monster PoV */
@@ -0,0 +1,64 @@
+/*
+ * File: list-packet-layouts.h
+ * Purpose: Layouts of the fixed-size packets
+ */
+
+/*
+ * Each entry generates a typed writer, Packet_write_<name>(), which checks for room once and
+ * stores its fields directly in the socket buffer. The result is the same as the equivalent
+ * Packet_printf() call, without parsing a format string.
+ *
+ * PKWn: packet type, writer name, then n field types
+ * PKBn: writer name, then n field types (packet body, no packet type)
+ *
+ * Field types are the Packet_printf() conversions: c, b, hd, hu, ld, lu
+ */
+
+/* Packets sent to the client */
+PKW2(LEV, lvl, hd, hd)
+PKW2(WEIGHT, weight, hd, hd)
+PKW6(PLUSSES, plusses, hd, hd, hd, hd, hd, hd)
+PKW2(AC, ac, hd, hd)
+PKW3(EXP, exp, ld, ld, hd)
+PKW1(GOLD, gold, ld)
+PKW2(HP, hp, hd, hd)
+PKW2(SP, sp, hd, hd)
+PKW3(VARIOUS, various, hd, hd, hd)
+PKW6(STAT, stat, c, hd, hd, hd, hd, hd)
+PKW3(INDEX, index, hd, hd, b)
+PKW3(TURN, turn, lu, lu, lu)
+PKW2(EXTRA, extra, b, b)
+PKW0(STATUS, status)
+PKW2(RECALL, recall, hd, hd)
+PKW2(LINE_INFO, line_info, hd, hd)
+PKW2(SPEED, speed, hd, hd)
+PKW2(STUDY, study, hd, c)
+PKW2(COUNT, count, b, hd)
+PKW1(SHOW_FLOOR, show_floor, b)
+PKW4(CHAR, char, b, b, hu, c)
+PKW6(CHAR, char_trn, b, b, hu, c, hu, c)
+PKW1(SOUND, sound, hd)
+PKW2(MINI_MAP, mini_map, hd, hd)
+PKW2(MONSTER_HEALTH, monster_health, c, b)
+PKW3(CURSOR, cursor, c, c, c)
+PKW1(DTRAP, dtrap, b)
+PKW2(TERM, term, c, hu)
+PKW4(PLAYER, player_pos, hd, hd, hd, hd)
+PKW4(MINIPOS, minipos, hd, hd, hd, hd)
+PKW2(FLUSH, flush, c, c)
+PKW2(LINE_DELTA, line_delta, hd, b)
+
+/* Packets sent in both directions */
+PKW1(KEEPALIVE, keepalive, ld)
+
+/* Packets sent to the server */
+PKW1(WALK, walk, c)
+PKW1(RUN, run, c)
+PKW2(TUNNEL, tunnel, c, b)
+PKW1(ALTER, alter, c)
+PKW1(REST, rest, hd)
+
+/* Packet bodies */
+PKB2(grid, c, hu)
+PKB3(grid_run, c, hu, hu)
+PKB2(grid_span, b, b)
@@ -162,3 +162,9 @@ PKT(CHANNEL, undefined, channel, undefined, channel)
 PKT(HISTORY, undefined, history, undefined, history)
 PKT(AUTOINSCR, autoinscriptions, undefined, undefined, autoinscriptions)
 PKT(PLAY_SETUP, undefined, undefined, play_setup, undefined)
+
+/*
+ * Packets added after 1.6.2.1 go here, so that older clients and servers keep the same
+ * numbering for the packets they know about
+ */
+PKT(LINE_DELTA, undefined, undefined, undefined, line_delta)
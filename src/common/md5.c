@@ -329,6 +329,30 @@ static void MD5_memset(byte_ptr output, int value, unsigned int len)
 
 
 /* Finally we put the hashing algorithm to work */
+/*
+ * Hex digest (33 chars with the terminator) of several buffers taken as one
+ */
+void MD5Digest(char *hex, char **bufs, int *lens, int num)
+{
+    MD5_CTX context;
+    unsigned char digest[NORMAL_WID];
+    const char *hexval = "0123456789abcdef";
+    int i;
+
+    MD5Init(&context);
+    for (i = 0; i < num; i++)
+        MD5Update(&context, (unsigned char*)bufs[i], (unsigned int)lens[i]);
+    MD5Final(digest, &context);
+
+    for (i = 0; i < 16; i++)
+    {
+        *hex++ = hexval[(digest[i] >> 4) & 0xf];
+        *hex++ = hexval[digest[i] & 0x0f];
+    }
+    *hex = '\0';
+}
+
+
 void MD5Password(char *string)
 {
     MD5_CTX context;
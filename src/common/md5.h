@@ -14,5 +14,6 @@
 #define MAX_PASS_LEN    40
 
 extern void MD5Password(char *string);
+extern void MD5Digest(char *hex, char **bufs, int *lens, int num);
 
 #endif
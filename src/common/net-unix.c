@@ -62,6 +62,8 @@ static char sourceid[] =
 #include <sys/time.h>
 #endif
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
@@ -443,6 +445,374 @@ int	fd;
 } /* GetSockAddr */
 
 
+/*
+ *******************************************************************************
+ *
+ *	Reverse name lookups
+ *
+ *******************************************************************************
+ * gethostbyaddr() can stall for seconds on a slow or dead nameserver, which
+ * would freeze the whole game.  Lookups are thus handed to a helper process
+ * started by SLResolverInit().  Callers always get an answer at once: the
+ * hostname when it is already in the cache, the dotted address otherwise
+ * while the helper resolves it in the background.
+ */
+#define SL_DNS_CACHE		64	/* Recent lookups remembered */
+#define SL_DNS_NAMELEN		256	/* Longest hostname kept */
+#define SL_DNS_EXPIRE		3600	/* Seconds before a lookup is redone */
+
+struct sl_dns_reply
+{
+    struct in_addr	addr;
+    char		name[SL_DNS_NAMELEN];
+};
+
+struct sl_dns_entry
+{
+    struct in_addr	addr;
+    char		name[SL_DNS_NAMELEN];
+    time_t		when;
+    int			state;
+};
+
+#define SL_DNS_FREE		0
+#define SL_DNS_PENDING		1
+#define SL_DNS_DONE		2
+
+static struct sl_dns_entry	sl_dns_cache[SL_DNS_CACHE];
+static int			sl_dns_req = -1, sl_dns_rep = -1;
+static pid_t			sl_dns_pid = -1;
+
+
+/*
+ * Default resolver, run by the helper process.
+ */
+static int
+#ifdef __STDC__
+sl_gethostbyaddr(struct in_addr addr, char *name, int namelen)
+#else
+sl_gethostbyaddr(addr, name, namelen)
+struct in_addr	addr;
+char	*name;
+int	namelen;
+#endif /* __STDC__ */
+{
+    struct hostent	*hp;
+
+    hp = gethostbyaddr((char *)&addr, sizeof(struct in_addr), AF_INET);
+    if (hp == NULL) return (-1);
+    my_strcpy(name, hp->h_name, namelen);
+    return (0);
+}
+
+
+/*
+ * The resolver used by the helper process.  It may be replaced by a stub
+ * before calling SLResolverInit(), so that name lookups can be exercised
+ * without a nameserver.
+ */
+int (*sl_resolver)(struct in_addr, char *, int) = sl_gethostbyaddr;
+
+
+/*
+ * Main loop of the helper process: read addresses, write back names.
+ */
+static void
+#ifdef __STDC__
+sl_resolver_loop(int in, int out)
+#else
+sl_resolver_loop(in, out)
+int	in;
+int	out;
+#endif /* __STDC__ */
+{
+    struct sl_dns_reply	rep;
+
+    while (read(in, &rep.addr, sizeof(rep.addr)) == sizeof(rep.addr))
+    {
+	if ((*sl_resolver)(rep.addr, rep.name, sizeof(rep.name)) == -1)
+	    my_strcpy(rep.name, inet_ntoa(rep.addr), sizeof(rep.name));
+
+	/* Replies are smaller than PIPE_BUF and thus written atomically */
+	if (write(out, &rep, sizeof(rep)) != sizeof(rep)) break;
+    }
+    _exit(0);
+}
+
+
+/*
+ *******************************************************************************
+ *
+ *	SLResolverInit()
+ *
+ *******************************************************************************
+ * Description
+ *	Starts the helper process doing reverse name lookups.  Until this
+ *	is called, SLLookupName() only ever returns dotted addresses.
+ *
+ * Input Parameters
+ *	None
+ *
+ * Output Parameters
+ *	None
+ *
+ * Return Value
+ *	-1 on failure, 0 on success.
+ *
+ * Globals Referenced
+ *	sl_resolver
+ *
+ * External Calls
+ *	pipe
+ *	fork
+ *	close
+ *
+ * Called By
+ *	User applications
+ */
+int
+#ifdef __STDC__
+SLResolverInit(void)
+#else
+SLResolverInit()
+#endif /* __STDC__ */
+{
+    int		req[2], rep[2];
+    long	fd, maxfd;
+
+    if (sl_dns_pid != -1) return (0);
+
+    if (pipe(req) == -1) return (-1);
+    if (pipe(rep) == -1)
+    {
+	close(req[0]);
+	close(req[1]);
+	return (-1);
+    }
+
+    sl_dns_pid = fork();
+    if (sl_dns_pid == -1)
+    {
+	close(req[0]);
+	close(req[1]);
+	close(rep[0]);
+	close(rep[1]);
+	return (-1);
+    }
+
+    if (sl_dns_pid == 0)
+    {
+	/* The parent's handlers would try to save the game */
+	signal(SIGINT, SIG_IGN);
+	signal(SIGQUIT, SIG_IGN);
+	signal(SIGTERM, SIG_DFL);
+	signal(SIGHUP, SIG_DFL);
+	signal(SIGPIPE, SIG_DFL);
+
+	/* Only keep our end of the pipes: listening socket, epoll, timer... */
+	maxfd = sysconf(_SC_OPEN_MAX);
+	if ((maxfd < 0) || (maxfd > 65536)) maxfd = 65536;
+	for (fd = 3; fd < maxfd; fd++)
+	{
+	    if ((fd != req[0]) && (fd != rep[1])) close((int)fd);
+	}
+	sl_resolver_loop(req[0], rep[1]);
+    }
+
+    close(req[0]);
+    close(rep[1]);
+    sl_dns_req = req[1];
+    sl_dns_rep = rep[0];
+
+    /* The game never waits on the helper */
+    SetSocketNonBlocking(sl_dns_req, 1);
+    SetSocketNonBlocking(sl_dns_rep, 1);
+
+    return (0);
+} /* SLResolverInit */
+
+
+/*
+ *******************************************************************************
+ *
+ *	SLResolverClose()
+ *
+ *******************************************************************************
+ * Description
+ *	Stops the helper process doing reverse name lookups.
+ *
+ * Input Parameters
+ *	None
+ *
+ * Output Parameters
+ *	None
+ *
+ * Return Value
+ *	None
+ *
+ * Globals Referenced
+ *	None
+ *
+ * External Calls
+ *	close
+ *	waitpid
+ *
+ * Called By
+ *	User applications
+ */
+void
+#ifdef __STDC__
+SLResolverClose(void)
+#else
+SLResolverClose()
+#endif /* __STDC__ */
+{
+    if (sl_dns_pid == -1) return;
+
+    /* Closing the request pipe makes the helper exit */
+    close(sl_dns_req);
+    close(sl_dns_rep);
+    kill(sl_dns_pid, SIGTERM);
+    waitpid(sl_dns_pid, NULL, 0);
+    sl_dns_req = sl_dns_rep = -1;
+    sl_dns_pid = -1;
+    memset(sl_dns_cache, 0, sizeof(sl_dns_cache));
+} /* SLResolverClose */
+
+
+/*
+ * Store the answers the helper process has sent since the last call.
+ */
+static void
+#ifdef __STDC__
+sl_resolver_poll(void)
+#else
+sl_resolver_poll()
+#endif /* __STDC__ */
+{
+    struct sl_dns_reply	rep;
+    int			i;
+    ssize_t		n;
+
+    while ((n = read(sl_dns_rep, &rep, sizeof(rep))) == sizeof(rep))
+    {
+	for (i = 0; i < SL_DNS_CACHE; i++)
+	{
+	    struct sl_dns_entry *ent = &sl_dns_cache[i];
+
+	    if ((ent->state != SL_DNS_PENDING) ||
+		(ent->addr.s_addr != rep.addr.s_addr)) continue;
+
+	    rep.name[sizeof(rep.name) - 1] = '\0';
+	    my_strcpy(ent->name, rep.name, sizeof(ent->name));
+	    ent->when = time(NULL);
+	    ent->state = SL_DNS_DONE;
+	}
+    }
+
+    /* The helper has died: reap it and go back to dotted addresses */
+    if (n == 0)
+    {
+	close(sl_dns_req);
+	close(sl_dns_rep);
+	waitpid(sl_dns_pid, NULL, WNOHANG);
+	sl_dns_req = sl_dns_rep = -1;
+	sl_dns_pid = -1;
+	memset(sl_dns_cache, 0, sizeof(sl_dns_cache));
+    }
+}
+
+
+/*
+ *******************************************************************************
+ *
+ *	SLLookupName()
+ *
+ *******************************************************************************
+ * Description
+ *	Returns the hostname of an address without ever blocking.  If the
+ *	name is not known yet, the dotted address is returned instead and
+ *	the helper process is asked to look it up, so that a later call
+ *	gets the hostname.
+ *
+ * Input Parameters
+ *	addr		- The address to look up.
+ *	namelen		- Maximum length of the name.
+ *
+ * Output Parameters
+ *	The hostname or the dotted address in a byte array.
+ *
+ * Return Value
+ *	1 if the name has been resolved, 0 otherwise.
+ *
+ * Globals Referenced
+ *	None
+ *
+ * External Calls
+ *	inet_ntoa
+ *
+ * Called By
+ *	User applications
+ */
+int
+#ifdef __STDC__
+SLLookupName(struct in_addr addr, char *name, int namelen)
+#else
+SLLookupName(addr, name, namelen)
+struct in_addr	addr;
+char	*name;
+int	namelen;
+#endif /* __STDC__ */
+{
+    struct sl_dns_entry	*ent = NULL, *old = &sl_dns_cache[0];
+    time_t		now = time(NULL);
+    int			i;
+
+    my_strcpy(name, inet_ntoa(addr), namelen);
+    if (sl_dns_pid == -1) return (0);
+
+    sl_resolver_poll();
+    if (sl_dns_pid == -1) return (0);
+
+    for (i = 0; i < SL_DNS_CACHE; i++)
+    {
+	if (sl_dns_cache[i].state == SL_DNS_FREE)
+	{
+	    if (old->state != SL_DNS_FREE) old = &sl_dns_cache[i];
+	    continue;
+	}
+	if (sl_dns_cache[i].addr.s_addr == addr.s_addr)
+	{
+	    ent = &sl_dns_cache[i];
+	    break;
+	}
+	if ((old->state != SL_DNS_FREE) && (sl_dns_cache[i].when < old->when))
+	    old = &sl_dns_cache[i];
+    }
+
+    if (ent && (now - ent->when < SL_DNS_EXPIRE))
+    {
+	if (ent->state == SL_DNS_PENDING) return (0);
+	my_strcpy(name, ent->name, namelen);
+	return (1);
+    }
+
+    /* Not known (or too old): ask the helper, reusing the oldest slot */
+    if (!ent) ent = old;
+    if (write(sl_dns_req, &addr, sizeof(addr)) != sizeof(addr))
+    {
+	/* The helper is busy, try again next time */
+	ent->state = SL_DNS_FREE;
+	return (0);
+    }
+    ent->addr = addr;
+    ent->when = now;
+    ent->state = SL_DNS_PENDING;
+
+    return (0);
+} /* SLLookupName */
+
+
 /*
  *******************************************************************************
  *
@@ -450,7 +820,8 @@ int	fd;
  *
  *******************************************************************************
  * Description
- *	Returns the hostname of the peer of connected stream socket.
+ *	Returns the hostname of the peer of connected stream socket, or
+ *	its dotted address while the name is still being looked up.
  *
  * Input Parameters
  *	fd		- The connected stream socket descriptor.
@@ -467,8 +838,7 @@ int	fd;
  *
  * External Calls
  *	getpeername
- *	gethostbyaddr
- *	inet_ntoa
+ *	SLLookupName
  *
  * Called By
  *	User applications
@@ -488,24 +858,14 @@ int	namelen;
 #ifdef UNIX_SOCKETS
     strcpy(name, "localhost");
 #else
-    int			len;
+    socklen_t		len;
     struct sockaddr_in	addr;
-    struct hostent	*hp;
 
     len = sizeof(struct sockaddr_in);
     if (getpeername(fd, (struct sockaddr *)&addr, &len) < 0)
 	return (-1);
 
-    hp = gethostbyaddr((char *)&addr.sin_addr.s_addr, 4, AF_INET);
-    if (hp != NULL)
-    {
-	strncpy(name, hp->h_name, namelen);
-    }
-    else
-    {
-	strncpy(name, inet_ntoa(addr.sin_addr), namelen);
-    }
-    name[namelen - 1] = '\0';
+    SLLookupName(addr.sin_addr, name, namelen);
 #endif
 
     return (0);
@@ -2125,6 +2485,66 @@ int	size;
     return retval;
 } /* DgramWrite */
 
+
+/*
+ *******************************************************************************
+ *
+ *	DgramWritev()
+ *
+ *******************************************************************************
+ * Description
+ *	Sends several buffers in one go on a connected stream socket.
+ *
+ * Input Parameters
+ *	fd		- The socket descriptor.
+ *	bufs		- Pointers to the message buffers.
+ *	lens		- Size of each buffer.
+ *	count		- Number of buffers (at most 4).
+ *
+ * Output Parameters
+ *	None
+ *
+ * Return Value
+ *	The number of bytes sent or -1 if any errors occured.
+ *
+ * Globals Referenced
+ *	None
+ *
+ * External Calls
+ *	writev()
+ *
+ * Called By
+ *	User applications
+ */
+int
+#ifdef __STDC__
+DgramWritev(int fd, char **bufs, int *lens, int count)
+#else
+DgramWritev(fd, bufs, lens, count)
+int	fd;
+char	**bufs;
+int	*lens;
+int	count;
+#endif /* __STDC__ */
+{
+    struct iovec	iov[4];
+    int		i, n = 0, retval;
+
+    for (i = 0; (i < count) && (n < 4); i++)
+    {
+        if (lens[i] <= 0) continue;
+        iov[n].iov_base = bufs[i];
+        iov[n].iov_len = lens[i];
+        n++;
+    }
+    if (!n) return 0;
+
+    cmw_priv_assert_netaccess();
+    retval = writev(fd, iov, n);
+    cmw_priv_deassert_netaccess();
+    return retval;
+} /* DgramWritev */
+
 
 /*
  *******************************************************************************
@@ -2311,8 +2731,8 @@ DgramLastaddr()
  *******************************************************************************
  * Description
  *	Does a name lookup for the last host address from the
- *	global variable sl_dgram_lastaddr.  If this nameserver
- *	query fails then it resorts to DgramLastaddr().
+ *	global variable sl_dgram_lastaddr.  If the name is not
+ *	known yet then it resorts to DgramLastaddr().
  *
  * Input Parameters
  *	None
@@ -2328,8 +2748,7 @@ DgramLastaddr()
  *	sl_dgram_lastaddr
  *
  * External Calls
- *	inet_ntoa
- *	gethostbyaddr
+ *	SLLookupName
  *
  * Called By
  *	User applications.
@@ -2346,17 +2765,10 @@ DgramLastname()
 #ifdef UNIX_SOCKETS
     return "localhost";
 #else
-    struct hostent	*he;
-    char		*str;
+    static char		name[SL_DNS_NAMELEN];
 
-    he = gethostbyaddr((char *)&sl_dgram_lastaddr.sin_addr,
-		       sizeof(struct in_addr), AF_INET);
-    if (he == NULL) {
-	str = inet_ntoa(sl_dgram_lastaddr.sin_addr);
-    } else {
-	str = (char *) he->h_name;
-    }
-    return str;
+    SLLookupName(sl_dgram_lastaddr.sin_addr, name, sizeof(name));
+    return name;
 #endif
 } /* DgramLastname */
 
@@ -46,6 +46,7 @@ extern struct sockaddr_un
 extern struct sockaddr_in
 #endif
     sl_dgram_lastaddr;
+extern int	(*sl_resolver)(struct in_addr, char *, int);
 
 #endif /* _SOCKLIB_LIBSOURCE */
 
@@ -61,6 +62,9 @@ extern int	CreateServerSocket(int);
 extern int	GetPortNum(int);
 extern char	*GetSockAddr(int);
 extern int	GetPeerName(int, char *, int);
+extern int	SLResolverInit(void);
+extern void	SLResolverClose(void);
+extern int	SLLookupName(struct in_addr, char *, int);
 extern int	CreateClientSocket(char *, int);
 extern int	SocketAccept(int);
 extern int	SocketLinger(int);
@@ -85,6 +89,7 @@ extern int	DgramReceive(int, char *, char *, int);
 extern int	DgramReply(int, char *, int);
 extern int	DgramRead(int fd, char *rbuf, int size);
 extern int	DgramWrite(int fd, char *wbuf, int size);
+extern int	DgramWritev(int fd, char **bufs, int *lens, int count);
 extern int	DgramSendRec(int, char *, int, char *, int, char *, int);
 extern char	*DgramLastaddr(void);
 extern char	*DgramLastname(void);
@@ -99,6 +104,9 @@ extern int	CreateServerSocket();
 extern int	GetPortNum();
 extern char	*GetSockAddr();
 extern int	GetPeerName();
+extern int	SLResolverInit();
+extern void	SLResolverClose();
+extern int	SLLookupName();
 extern int	CreateClientSocket();
 extern int	SocketAccept();
 extern int	SocketLinger();
@@ -122,6 +130,7 @@ extern int	DgramReceive();
 extern int	DgramReply();
 extern int	DgramRead();
 extern int	DgramWrite();
+extern int	DgramWritev();
 extern int	DgramSendRec();
 extern char	*DgramLastaddr();
 extern char	*DgramLastname();
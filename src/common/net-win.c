@@ -1162,6 +1162,63 @@ DgramWrite(int fd, char *wbuf, int size)
 } /* DgramWrite */
 
 
+/*
+ *******************************************************************************
+ *
+ *  DgramWritev()
+ *
+ *******************************************************************************
+ * Description
+ *  Sends several buffers in one go on a connected stream socket.
+ *
+ * Input Parameters
+ *  fd      - The socket descriptor.
+ *  bufs        - Pointers to the message buffers.
+ *  lens        - Size of each buffer.
+ *  count       - Number of buffers (at most 4).
+ *
+ * Output Parameters
+ *  None
+ *
+ * Return Value
+ *  The number of bytes sent or -1 if any errors occured.
+ *
+ * Globals Referenced
+ *  errno   for returning an error value
+ *
+ * External Calls
+ *  WSASend()
+ *
+ * Called By
+ *  User applications
+ */
+int
+DgramWritev(int fd, char **bufs, int *lens, int count)
+{
+    WSABUF wsabuf[4];
+    DWORD sent = 0;
+    int i, n = 0;
+
+    for (i = 0; (i < count) && (n < 4); i++)
+    {
+        if (lens[i] <= 0) continue;
+        wsabuf[n].buf = bufs[i];
+        wsabuf[n].len = lens[i];
+        n++;
+    }
+    if (!n) return 0;
+
+    /* If necessary, set errno */
+    if (WSASend(fd, wsabuf, n, &sent, 0, NULL, NULL) == SOCKET_ERROR)
+    {
+        errno = WSAGetLastError();
+        return -1;
+    }
+
+    return (int)sent;
+} /* DgramWritev */
+
+
 /*
  *******************************************************************************
  *
@@ -1343,8 +1400,7 @@ DgramLastaddr(void)
  *  sl_dgram_lastaddr
  *
  * External Calls
- *  inet_ntoa
- *  gethostbyaddr
+ *  SLLookupName
  *
  * Called By
  *  User applications.
@@ -1354,16 +1410,10 @@ DgramLastaddr(void)
 char *
 DgramLastname(void)
 {
-    struct hostent *he;
-    char *str;
+    static char name[NORMAL_WID];
 
-    he = gethostbyaddr((char *)&sl_dgram_lastaddr.sin_addr,
-               sizeof(struct in_addr), AF_INET);
-    if (he == NULL)
-        str = inet_ntoa(sl_dgram_lastaddr.sin_addr);
-    else
-        str = (char *)he->h_name;
-    return str;
+    SLLookupName(sl_dgram_lastaddr.sin_addr, name, sizeof(name));
+    return name;
 } /* DgramLastname */
 
 
@@ -1607,6 +1657,118 @@ GetSockAddr(int fd)
 } /* GetSockAddr */
 
 
+/*
+ *******************************************************************************
+ *
+ *  SLResolverInit()
+ *
+ *******************************************************************************
+ * Description
+ *  Starts the reverse name lookup helper.  There is none on Windows:
+ *  SLLookupName() calls gethostbyaddr() directly.
+ *
+ * Input Parameters
+ *  None
+ *
+ * Output Parameters
+ *  None
+ *
+ * Return Value
+ *  0.
+ *
+ * Globals Referenced
+ *  None
+ *
+ * External Calls
+ *  None
+ *
+ * Called By
+ *  User applications
+ */
+int SLResolverInit(void)
+{
+    return (0);
+} /* SLResolverInit */
+
+
+/*
+ *******************************************************************************
+ *
+ *  SLResolverClose()
+ *
+ *******************************************************************************
+ * Description
+ *  Stops the reverse name lookup helper.
+ *
+ * Input Parameters
+ *  None
+ *
+ * Output Parameters
+ *  None
+ *
+ * Return Value
+ *  None
+ *
+ * Globals Referenced
+ *  None
+ *
+ * External Calls
+ *  None
+ *
+ * Called By
+ *  User applications
+ */
+void SLResolverClose(void)
+{
+} /* SLResolverClose */
+
+
+/*
+ *******************************************************************************
+ *
+ *  SLLookupName()
+ *
+ *******************************************************************************
+ * Description
+ *  Returns the hostname of an address.  If this nameserver query
+ *  fails then it resorts to the dotted address.
+ *
+ * Input Parameters
+ *  addr        - The address to look up.
+ *  namelen     - Maximum length of the name.
+ *
+ * Output Parameters
+ *  The hostname or the dotted address in a byte array.
+ *
+ * Return Value
+ *  1 if the name has been resolved, 0 otherwise.
+ *
+ * Globals Referenced
+ *  None
+ *
+ * External Calls
+ *  gethostbyaddr
+ *  inet_ntoa
+ *
+ * Called By
+ *  User applications
+ */
+int SLLookupName(struct in_addr addr, char *name, int namelen)
+{
+    struct hostent *hp;
+
+    hp = gethostbyaddr((char *)&addr, sizeof(struct in_addr), AF_INET);
+    if (hp == NULL)
+    {
+        my_strcpy(name, inet_ntoa(addr), namelen);
+        return (0);
+    }
+
+    my_strcpy(name, hp->h_name, namelen);
+    return (1);
+} /* SLLookupName */
+
+
 /*
  *******************************************************************************
  *
@@ -1614,7 +1776,8 @@ GetSockAddr(int fd)
  *
  *******************************************************************************
  * Description
- *  Returns the hostname of the peer of connected stream socket.
+ *  Returns the hostname of the peer of connected stream socket, or
+ *  its dotted address while the name is not known.
  *
  * Input Parameters
  *  fd      - The connected stream socket descriptor.
@@ -1631,8 +1794,7 @@ GetSockAddr(int fd)
  *
  * External Calls
  *  getpeername
- *  gethostbyaddr
- *  inet_ntoa
+ *  SLLookupName
  *
  * Called By
  *  User applications
@@ -1643,17 +1805,12 @@ int SLGetPeerName(int fd, char *name, int namelen)
 {
     int len;
     struct sockaddr_in addr;
-    struct hostent *hp;
 
     len = sizeof(struct sockaddr_in);
     if (getpeername(fd, (struct sockaddr *)&addr, &len) == SOCKET_ERROR)
     return (-1);
 
-    hp = gethostbyaddr((char *)&addr.sin_addr.s_addr, 4, AF_INET);
-    if (hp != NULL)
-        my_strcpy(name, hp->h_name, namelen);
-    else
-        my_strcpy(name, inet_ntoa(addr.sin_addr), namelen);
+    SLLookupName(addr.sin_addr, name, namelen);
 
     return (0);
 } /* GetPeerName */
@@ -35,7 +35,11 @@ extern int  DgramReceiveAny(int, char *, int);
 extern int  DgramReply(int, char *, int);
 extern int  DgramRead(int fd, char *rbuf, int size);
 extern int  DgramWrite(int fd, char *wbuf, int size);
+extern int  DgramWritev(int fd, char **bufs, int *lens, int count);
 extern char *DgramLastname(void);
+extern int  SLResolverInit(void);
+extern void SLResolverClose(void);
+extern int  SLLookupName(struct in_addr addr, char *name, int namelen);
 extern void DgramClose(int);
 extern void GetLocalHostName(char *, unsigned);
 extern int  CreateServerSocket(int);
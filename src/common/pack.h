@@ -33,6 +33,22 @@ enum
 #define CONNTYPE_MONITOR    0x02
 #define CONNTYPE_ERROR      0xFF
 
+/*
+ * Client capabilities
+ *
+ * A client advertises the features it understands after the account info of the contact
+ * packet; the server answers with the ones it will actually use at the end of its reply.
+ * Older clients send nothing and get the classic protocol.
+ */
+#define CAPS_LINE_DELTA     0x00000001 /* Map rows as runs of changed grids (PKT_LINE_DELTA) */
+#define CAPS_COMPRESS       0x00000002 /* Server to client stream is deflated after the reply */
+#define CAPS_STRUCT_CACHE   0x00000004 /* Struct info hash in the reply, cached struct info skipped */
+#ifdef USE_ZLIB
+#define CAPS_SUPPORTED      (CAPS_LINE_DELTA | CAPS_COMPRESS | CAPS_STRUCT_CACHE)
+#else
+#define CAPS_SUPPORTED      (CAPS_LINE_DELTA | CAPS_STRUCT_CACHE)
+#endif
+
 /*
  * Connection states
  */
@@ -62,6 +78,9 @@ enum
 #define STRUCT_INFO_TIMED   14
 #define STRUCT_INFO_PROPS   15
 
+/* Struct info is sent in three setup phases (PKT_PLAY 1 to 3) */
+#define STRUCT_INFO_PHASES  3
+
 /*
  * PKT_TERM helpers
  */
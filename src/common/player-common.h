@@ -787,6 +787,8 @@ struct player
     struct loc old_offset_grid;
     cave_view_type **scr_info;
     cave_view_type **trn_info;
+    bitflag **scr_dirty;                    /* Grids to send to the client at the end of the turn */
+    bool scr_dirty_any;                     /* Some grids are waiting to be sent */
     char msg_log[MAX_MSG_HIST][NORMAL_WID]; /* Message history log */
     int16_t msg_hist_ptr;                   /* Where will the next message be stored */
     uint8_t last_dir;                       /* Last direction moved (used for swapping places) */
@@ -816,6 +818,10 @@ struct player
     bool bubble_colour;                     /* Current warning colour for slow time bubbles */
     int bubble_speed;                       /* Current speed for slow time bubbles */
     uint32_t blink_speed;                   /* Current blink speed for slow time bubbles */
+    hturn timefactor_turn;                  /* Game turn the time factor was computed on */
+    int timefactor;                         /* Time factor computed on that turn */
+    hturn in_los_turn;                      /* Game turn monsters in LoS were checked on */
+    bool in_los;                            /* Monsters were in LoS on that turn */
     int arena_num;                          /* What arena this guy is in */
     uint32_t window_flag;
     bool prevents[128];                     /* Cache of "^" inscriptions */
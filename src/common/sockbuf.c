@@ -18,6 +18,66 @@
 
 
 #include "angband.h"
+#ifdef USE_ZLIB
+#include <zlib.h>
+
+
+/*
+ * Stream compression state attached to a socket buffer.
+ *
+ * When writing, the socket buffer collects raw packets as usual and is deflated into "buf"
+ * on flush; "buf" then holds the compressed bytes the socket hasn't accepted yet, starting
+ * at "off" (the space before "off" is only reclaimed when more room is needed).
+ * When reading, "buf" holds compressed bytes from the socket that haven't been inflated yet.
+ */
+struct sockbuf_zstream
+{
+    z_stream strm;
+    bool inflating;
+    char *buf;
+    int size;
+    int len;
+    int off;
+};
+#endif
+
+
+/*
+ * Ring mode: the pending data of a write buffer starts at "ptr" and may wrap around the end
+ * of the buffer, so that partial writes never have to move the remaining data back.
+ */
+static int Sockbuf_ring_segments(sockbuf_t *sbuf, char **bufs, int *lens)
+{
+    int head = sbuf->ptr - sbuf->buf;
+
+    bufs[0] = sbuf->ptr;
+    lens[0] = MIN(sbuf->len, sbuf->size - head);
+    bufs[1] = sbuf->buf;
+    lens[1] = sbuf->len - lens[0];
+
+    return (lens[1]? 2: 1);
+}
+
+
+static void Sockbuf_ring_consume(sockbuf_t *sbuf, int len)
+{
+    sbuf->len -= len;
+    if (sbuf->len == 0)
+        sbuf->ptr = sbuf->buf;
+    else
+        sbuf->ptr = sbuf->buf + (sbuf->ptr - sbuf->buf + len) % sbuf->size;
+}
+
+
+static void Sockbuf_ring_append(sockbuf_t *sbuf, char *buf, int len)
+{
+    int tail = (sbuf->ptr - sbuf->buf + sbuf->len) % sbuf->size;
+    int n = MIN(len, sbuf->size - tail);
+
+    memcpy(sbuf->buf + tail, buf, n);
+    memcpy(sbuf->buf, buf + n, len - n);
+    sbuf->len += len;
+}
 
 
 int Sockbuf_init(sockbuf_t *sbuf, int sock, int size, int state)
@@ -32,6 +92,9 @@ int Sockbuf_init(sockbuf_t *sbuf, int sock, int size, int state)
     sbuf->size = size;
     sbuf->ptr = sbuf->buf;
     sbuf->state = state;
+    sbuf->zs = NULL;
+    sbuf->zraw = sbuf->zwire = 0;
+    sbuf->nread = sbuf->nsent = sbuf->nblock = 0;
 
     return 0;
 }
@@ -39,6 +102,19 @@ int Sockbuf_init(sockbuf_t *sbuf, int sock, int size, int state)
 
 int Sockbuf_cleanup(sockbuf_t *sbuf)
 {
+#ifdef USE_ZLIB
+    struct sockbuf_zstream *zs = sbuf->zs;
+
+    if (zs)
+    {
+        if (zs->inflating) inflateEnd(&zs->strm);
+        else deflateEnd(&zs->strm);
+        mem_free(zs->buf);
+        mem_free(zs);
+        sbuf->zs = NULL;
+    }
+#endif
+
     mem_free(sbuf->buf);
     sbuf->buf = NULL;
     sbuf->ptr = NULL;
@@ -147,6 +223,199 @@ int Sockbuf_rollback(sockbuf_t *sbuf, int len)
 }
 
 
+#ifdef USE_ZLIB
+/*
+ * Deflate some raw data into the compressed backlog.
+ */
+static int Sockbuf_deflate(sockbuf_t *sbuf, char *buf, int len, int flush)
+{
+    struct sockbuf_zstream *zs = sbuf->zs;
+
+    zs->strm.next_in = (Bytef*)buf;
+    zs->strm.avail_in = len;
+
+    do
+    {
+        if (zs->size - zs->len < 64)
+        {
+            /* Reclaim the space already sent before growing the backlog */
+            if (zs->off > 0)
+            {
+                memmove(zs->buf, zs->buf + zs->off, zs->len - zs->off);
+                zs->len -= zs->off;
+                zs->off = 0;
+            }
+            if (zs->size - zs->len < 64)
+            {
+                zs->size *= 2;
+                zs->buf = mem_realloc(zs->buf, zs->size);
+            }
+        }
+        zs->strm.next_out = (Bytef*)(zs->buf + zs->len);
+        zs->strm.avail_out = zs->size - zs->len;
+        if (deflate(&zs->strm, flush) == Z_STREAM_ERROR)
+        {
+            errno = 0;
+            plog("Can't deflate socket data");
+            return -1;
+        }
+        zs->len = (char*)zs->strm.next_out - zs->buf;
+    }
+    while ((zs->strm.avail_out == 0) || (zs->strm.avail_in > 0));
+
+    sbuf->zraw += len;
+
+    return 0;
+}
+
+
+/*
+ * Deflate the pending data of a compressed socket buffer (followed by "len" bytes from "buf")
+ * and send as much of it as the socket will take. What the socket doesn't accept is kept for
+ * the next flush.
+ */
+static int Sockbuf_flush_compressed(sockbuf_t *sbuf, char *buf, int len)
+{
+    struct sockbuf_zstream *zs = sbuf->zs;
+    char *bufs[3];
+    int lens[3];
+    int i, n = 0;
+
+    if (BIT(sbuf->state, SOCKBUF_RING) != 0)
+        n = Sockbuf_ring_segments(sbuf, bufs, lens);
+    else
+    {
+        bufs[n] = sbuf->buf;
+        lens[n++] = sbuf->len;
+    }
+    bufs[n] = buf;
+    lens[n++] = len;
+
+    if (sbuf->len + len > 0)
+    {
+        /* The peer isn't reading, give up like a full uncompressed buffer would */
+        if (zs->len - zs->off > sbuf->size)
+        {
+            errno = 0;
+            plog_fmt("Compressed socket backlog too big (%d, %d)", zs->len - zs->off,
+                sbuf->size);
+            return -1;
+        }
+
+        /* Sync flush at the end so that the peer can decode everything we have so far */
+        for (i = 0; i < n; i++)
+        {
+            if (Sockbuf_deflate(sbuf, bufs[i], lens[i],
+                ((i == n - 1)? Z_SYNC_FLUSH: Z_NO_FLUSH)) == -1)
+            {
+                return -1;
+            }
+        }
+
+        Sockbuf_clear(sbuf);
+    }
+
+    if (zs->len == zs->off) return 0;
+
+    errno = 0;
+    while ((len = DgramWrite(sbuf->sock, zs->buf + zs->off, zs->len - zs->off)) <= 0)
+    {
+        if (errno == EINTR)
+        {
+            errno = 0;
+            continue;
+        }
+        if (errno != EWOULDBLOCK && errno != EAGAIN)
+        {
+            plog("Can't write on socket");
+            return -1;
+        }
+        sbuf->nblock++;
+        return 0;
+    }
+    sbuf->zwire += len;
+    sbuf->nsent += len;
+    zs->off += len;
+    if (zs->off == zs->len) zs->len = zs->off = 0;
+
+    return len;
+}
+
+
+/*
+ * Read from the socket into a compressed socket buffer and inflate as much as fits.
+ */
+static int Sockbuf_read_compressed(sockbuf_t *sbuf, int max)
+{
+    struct sockbuf_zstream *zs = sbuf->zs;
+    int len, ret;
+
+    do
+    {
+        /* Only hit the socket once the previous batch has been inflated */
+        if (zs->len == 0)
+        {
+            errno = 0;
+            while ((len = DgramRead(sbuf->sock, zs->buf, zs->size)) <= 0)
+            {
+                if (len == 0) return 0;
+                if (errno == EINTR)
+                {
+                    errno = 0;
+                    continue;
+                }
+                if (errno != EWOULDBLOCK && errno != EAGAIN)
+                {
+                    /* Give a different message for disconnected clients */
+                    if (errno != ECONNRESET)
+                    {
+                        plog_fmt("Can't read on socket: error %d", errno);
+                        plog(GetSocketErrorMessageAux(errno));
+                    }
+                    else
+                        plog("Disconnected from server...");
+                    return -1;
+                }
+                sbuf->nblock++;
+                return 0;
+            }
+            zs->len = len;
+            sbuf->zwire += len;
+            sbuf->nread += len;
+        }
+
+        zs->strm.next_in = (Bytef*)zs->buf;
+        zs->strm.avail_in = zs->len;
+        zs->strm.next_out = (Bytef*)(sbuf->buf + sbuf->len);
+        zs->strm.avail_out = max;
+        ret = inflate(&zs->strm, Z_SYNC_FLUSH);
+        if ((ret != Z_OK) && (ret != Z_BUF_ERROR))
+        {
+            errno = 0;
+            plog_fmt("Can't inflate socket data (%d)", ret);
+            return -1;
+        }
+        len = max - zs->strm.avail_out;
+        sbuf->len += len;
+        sbuf->zraw += len;
+        max -= len;
+
+        /* Keep what didn't fit for the next read */
+        zs->len = zs->strm.avail_in;
+        memmove(zs->buf, zs->strm.next_in, zs->len);
+    }
+
+    /*
+     * We may have been handed only the start of a block: since the sender always flushes
+     * whole blocks, the rest of it is already on its way
+     */
+    while (sbuf->len == 0);
+
+    return sbuf->len;
+}
+#endif
+
+
 int Sockbuf_flush(sockbuf_t *sbuf)
 {
     int len, i;
@@ -165,6 +434,9 @@ int Sockbuf_flush(sockbuf_t *sbuf)
         plog_fmt("No flush on locked socket buffer (0x%02x)", sbuf->state);
         return -1;
     }
+#ifdef USE_ZLIB
+    if (sbuf->zs) return Sockbuf_flush_compressed(sbuf, NULL, 0);
+#endif
     if (sbuf->len <= 0)
     {
         if (sbuf->len < 0)
@@ -176,6 +448,7 @@ int Sockbuf_flush(sockbuf_t *sbuf)
         }
         return 0;
     }
+    if (BIT(sbuf->state, SOCKBUF_RING) != 0) return Sockbuf_send(sbuf, NULL, 0);
 
     if (BIT(sbuf->state, SOCKBUF_DGRAM) != 0)
     {
@@ -228,8 +501,10 @@ int Sockbuf_flush(sockbuf_t *sbuf)
                 plog("Can't write on socket");
                 return -1;
             }
+            sbuf->nblock++;
             return 0;
         }
+        sbuf->nsent += len;
         Sockbuf_advance(sbuf, len);
     }
 
@@ -257,6 +532,11 @@ int Sockbuf_write(sockbuf_t *sbuf, char *buf, int len)
         if (Sockbuf_flush(sbuf) == -1) return -1;
         if (sbuf->size - sbuf->len < len) return 0;
     }
+    if (BIT(sbuf->state, SOCKBUF_RING) != 0)
+    {
+        Sockbuf_ring_append(sbuf, buf, len);
+        return len;
+    }
     memcpy(sbuf->buf + sbuf->len, buf, len);
     sbuf->len += len;
 
@@ -264,6 +544,83 @@ int Sockbuf_write(sockbuf_t *sbuf, char *buf, int len)
 }
 
 
+/*
+ * Send the pending data of a stream socket buffer followed by "len" bytes from "buf",
+ * without copying "buf" into the socket buffer first. Whatever the socket doesn't accept
+ * is queued in the socket buffer.
+ *
+ * Returns the number of bytes written to the socket or -1 on error (including when the
+ * rest doesn't fit in the socket buffer).
+ */
+int Sockbuf_send(sockbuf_t *sbuf, char *buf, int len)
+{
+    char *bufs[3];
+    int lens[3];
+    int n, written;
+
+    if (BIT(sbuf->state, SOCKBUF_RING) == 0)
+    {
+        if (Sockbuf_write(sbuf, buf, len) != len) return -1;
+        return Sockbuf_flush(sbuf);
+    }
+    if (BIT(sbuf->state, SOCKBUF_WRITE) == 0)
+    {
+        errno = 0;
+        plog("No send on non-writable socket buffer");
+        return -1;
+    }
+#ifdef USE_ZLIB
+    if (sbuf->zs) return Sockbuf_flush_compressed(sbuf, buf, len);
+#endif
+
+    n = Sockbuf_ring_segments(sbuf, bufs, lens);
+    bufs[n] = buf;
+    lens[n++] = len;
+
+    errno = 0;
+    while ((written = DgramWritev(sbuf->sock, bufs, lens, n)) <= 0)
+    {
+        if ((sbuf->len + len == 0) && (written == 0)) return 0;
+        if (errno == EINTR)
+        {
+            errno = 0;
+            continue;
+        }
+        if (errno != EWOULDBLOCK && errno != EAGAIN)
+        {
+            plog("Can't write on socket");
+            return -1;
+        }
+        sbuf->nblock++;
+        written = 0;
+        break;
+    }
+    sbuf->nsent += written;
+
+    /* Queue what the socket didn't take */
+    if (written < sbuf->len)
+        Sockbuf_ring_consume(sbuf, written);
+    else
+    {
+        buf += written - sbuf->len;
+        len -= written - sbuf->len;
+        Sockbuf_clear(sbuf);
+    }
+    if (len > 0)
+    {
+        if (sbuf->size - sbuf->len < len)
+        {
+            errno = 0;
+            plog_fmt("Socket buffer full (%d, %d, %d)", sbuf->size, sbuf->len, len);
+            return -1;
+        }
+        Sockbuf_ring_append(sbuf, buf, len);
+    }
+
+    return written;
+}
+
+
 int Sockbuf_read(sockbuf_t *sbuf)
 {
     int max, i, len;
@@ -287,6 +644,9 @@ int Sockbuf_read(sockbuf_t *sbuf)
         }
         return -1;
     }
+#ifdef USE_ZLIB
+    if (sbuf->zs) return Sockbuf_read_compressed(sbuf, max);
+#endif
     if (BIT(sbuf->state, SOCKBUF_DGRAM) != 0)
     {
         errno = 0;
@@ -313,6 +673,7 @@ int Sockbuf_read(sockbuf_t *sbuf)
             errno = 0;
         }
         sbuf->len += len;
+        sbuf->nread += len;
     }
     else
     {
@@ -337,9 +698,11 @@ int Sockbuf_read(sockbuf_t *sbuf)
                     plog("Disconnected from server...");
                 return -1;
             }
+            sbuf->nblock++;
             return 0;
         }
         sbuf->len += len;
+        sbuf->nread += len;
     }
 
     return sbuf->len;
@@ -367,6 +730,97 @@ int Sockbuf_copy(sockbuf_t *dest, sockbuf_t *src, int len)
 }
 
 
+/*
+ * Compress everything written to a stream socket buffer from now on, using the given
+ * zlib level. Returns -1 if compression isn't available.
+ */
+int Sockbuf_compress(sockbuf_t *sbuf, int level)
+{
+#ifdef USE_ZLIB
+    struct sockbuf_zstream *zs;
+
+    if (sbuf->zs || (BIT(sbuf->state, SOCKBUF_DGRAM | SOCKBUF_LOCK) != 0)) return -1;
+
+    zs = mem_zalloc(sizeof(*zs));
+    if (deflateInit(&zs->strm, level) != Z_OK)
+    {
+        errno = 0;
+        plog("Can't initialize stream compression");
+        mem_free(zs);
+        return -1;
+    }
+    zs->size = sbuf->size;
+    zs->buf = mem_alloc(zs->size);
+    sbuf->zs = zs;
+
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+
+/*
+ * Decompress everything read from a stream socket buffer from now on.
+ * Returns -1 if compression isn't available.
+ */
+int Sockbuf_decompress(sockbuf_t *sbuf)
+{
+#ifdef USE_ZLIB
+    struct sockbuf_zstream *zs;
+
+    if (sbuf->zs || (BIT(sbuf->state, SOCKBUF_DGRAM | SOCKBUF_LOCK) != 0)) return -1;
+
+    zs = mem_zalloc(sizeof(*zs));
+    if (inflateInit(&zs->strm) != Z_OK)
+    {
+        errno = 0;
+        plog("Can't initialize stream decompression");
+        mem_free(zs);
+        return -1;
+    }
+    zs->inflating = true;
+    zs->size = sbuf->size;
+    zs->buf = mem_alloc(zs->size);
+    sbuf->zs = zs;
+
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+
+/*
+ * Amount of data waiting to be written on the socket.
+ */
+int Sockbuf_pending(sockbuf_t *sbuf)
+{
+#ifdef USE_ZLIB
+    struct sockbuf_zstream *zs = sbuf->zs;
+
+    if (zs && !zs->inflating) return sbuf->len + zs->len - zs->off;
+#endif
+
+    return sbuf->len;
+}
+
+
+/*
+ * Amount of compressed data already received but not yet inflated into the buffer.
+ */
+int Sockbuf_backlog(sockbuf_t *sbuf)
+{
+#ifdef USE_ZLIB
+    struct sockbuf_zstream *zs = sbuf->zs;
+
+    if (zs && zs->inflating) return zs->len;
+#endif
+
+    return 0;
+}
+
+
 /*
  * Writes a packet to the socket
  *
@@ -558,6 +1012,204 @@ int Packet_printf(sockbuf_t *sbuf, char *fmt, ...)
 }
 
 
+/*
+ * Typed packet writers
+ *
+ * These write fixed-size packets with a single bounds check, and return the same values as
+ * Packet_printf() would: the number of bytes written, or 0 (datagram) or -1 (stream) when
+ * there is not enough room left.
+ */
+#define PKW_SIZE_c  1
+#define PKW_SIZE_b  1
+#define PKW_SIZE_hd 2
+#define PKW_SIZE_hu 2
+#define PKW_SIZE_ld 4
+#define PKW_SIZE_lu 4
+
+#define PKW_PUT_c(B, V) \
+    *(B)++ = (char)(V);
+#define PKW_PUT_b(B, V) \
+    *(B)++ = (char)(V);
+#define PKW_PUT_hd(B, V) \
+    *(B)++ = (char)((V) >> 8); *(B)++ = (char)(V);
+#define PKW_PUT_hu(B, V) \
+    *(B)++ = (char)((V) >> 8); *(B)++ = (char)(V);
+#define PKW_PUT_ld(B, V) \
+    *(B)++ = (char)((V) >> 24); *(B)++ = (char)((V) >> 16); *(B)++ = (char)((V) >> 8); \
+    *(B)++ = (char)(V);
+#define PKW_PUT_lu(B, V) \
+    *(B)++ = (char)((V) >> 24); *(B)++ = (char)((V) >> 16); *(B)++ = (char)((V) >> 8); \
+    *(B)++ = (char)(V);
+
+/* Same check as Packet_printf(), which always keeps one byte free */
+#define PKW_BEGIN(SIZE) \
+    char *buf = sbuf->buf + sbuf->len; \
+    if (sbuf->len + (SIZE) >= sbuf->size) return Packet_full(sbuf);
+
+#define PKW_END \
+    sbuf->len = buf - sbuf->buf; \
+    return buf - start;
+
+static int Packet_full(sockbuf_t *sbuf)
+{
+    return ((BIT(sbuf->state, SOCKBUF_DGRAM) != 0)? 0: -1);
+}
+
+#define PKW0(T, N) \
+int Packet_write_##N(sockbuf_t *sbuf) \
+{ \
+    char *start; \
+    PKW_BEGIN(1) \
+    start = buf; \
+    *buf++ = (char)PKT_##T; \
+    PKW_END \
+}
+#define PKW1(T, N, A) \
+int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A a) \
+{ \
+    char *start; \
+    PKW_BEGIN(1 + PKW_SIZE_##A) \
+    start = buf; \
+    *buf++ = (char)PKT_##T; \
+    PKW_PUT_##A(buf, a) \
+    PKW_END \
+}
+#define PKW2(T, N, A, B) \
+int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A a, PKW_TYPE_##B b) \
+{ \
+    char *start; \
+    PKW_BEGIN(1 + PKW_SIZE_##A + PKW_SIZE_##B) \
+    start = buf; \
+    *buf++ = (char)PKT_##T; \
+    PKW_PUT_##A(buf, a) \
+    PKW_PUT_##B(buf, b) \
+    PKW_END \
+}
+#define PKW3(T, N, A, B, C) \
+int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A a, PKW_TYPE_##B b, PKW_TYPE_##C c) \
+{ \
+    char *start; \
+    PKW_BEGIN(1 + PKW_SIZE_##A + PKW_SIZE_##B + PKW_SIZE_##C) \
+    start = buf; \
+    *buf++ = (char)PKT_##T; \
+    PKW_PUT_##A(buf, a) \
+    PKW_PUT_##B(buf, b) \
+    PKW_PUT_##C(buf, c) \
+    PKW_END \
+}
+#define PKW4(T, N, A, B, C, D) \
+int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A a, PKW_TYPE_##B b, PKW_TYPE_##C c, \
+    PKW_TYPE_##D d) \
+{ \
+    char *start; \
+    PKW_BEGIN(1 + PKW_SIZE_##A + PKW_SIZE_##B + PKW_SIZE_##C + PKW_SIZE_##D) \
+    start = buf; \
+    *buf++ = (char)PKT_##T; \
+    PKW_PUT_##A(buf, a) \
+    PKW_PUT_##B(buf, b) \
+    PKW_PUT_##C(buf, c) \
+    PKW_PUT_##D(buf, d) \
+    PKW_END \
+}
+#define PKW6(T, N, A, B, C, D, E, F) \
+int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A a, PKW_TYPE_##B b, PKW_TYPE_##C c, \
+    PKW_TYPE_##D d, PKW_TYPE_##E e, PKW_TYPE_##F f) \
+{ \
+    char *start; \
+    PKW_BEGIN(1 + PKW_SIZE_##A + PKW_SIZE_##B + PKW_SIZE_##C + PKW_SIZE_##D + PKW_SIZE_##E + \
+        PKW_SIZE_##F) \
+    start = buf; \
+    *buf++ = (char)PKT_##T; \
+    PKW_PUT_##A(buf, a) \
+    PKW_PUT_##B(buf, b) \
+    PKW_PUT_##C(buf, c) \
+    PKW_PUT_##D(buf, d) \
+    PKW_PUT_##E(buf, e) \
+    PKW_PUT_##F(buf, f) \
+    PKW_END \
+}
+#define PKB2(N, A, B) \
+int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A a, PKW_TYPE_##B b) \
+{ \
+    char *start; \
+    PKW_BEGIN(PKW_SIZE_##A + PKW_SIZE_##B) \
+    start = buf; \
+    PKW_PUT_##A(buf, a) \
+    PKW_PUT_##B(buf, b) \
+    PKW_END \
+}
+#define PKB3(N, A, B, C) \
+int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A a, PKW_TYPE_##B b, PKW_TYPE_##C c) \
+{ \
+    char *start; \
+    PKW_BEGIN(PKW_SIZE_##A + PKW_SIZE_##B + PKW_SIZE_##C) \
+    start = buf; \
+    PKW_PUT_##A(buf, a) \
+    PKW_PUT_##B(buf, b) \
+    PKW_PUT_##C(buf, c) \
+    PKW_END \
+}
+#include "list-packet-layouts.h"
+#undef PKW0
+#undef PKW1
+#undef PKW2
+#undef PKW3
+#undef PKW4
+#undef PKW6
+#undef PKB2
+#undef PKB3
+
+
+/*
+ * Write an array of int16_t (as "%hd" each) with a single bounds check
+ */
+int Packet_write_hd_array(sockbuf_t *sbuf, const int16_t *vals, int num)
+{
+    char *start;
+    int i;
+
+    PKW_BEGIN(num * PKW_SIZE_hd)
+    start = buf;
+    for (i = 0; i < num; i++)
+    {
+        PKW_PUT_hd(buf, vals[i])
+    }
+    PKW_END
+}
+
+
+/*
+ * Write raw bytes (as "%c" each) with a single bounds check
+ */
+int Packet_write_bytes(sockbuf_t *sbuf, const char *data, int num)
+{
+    char *start;
+
+    PKW_BEGIN(num)
+    start = buf;
+    memcpy(buf, data, num);
+    buf += num;
+    PKW_END
+}
+
+
+/*
+ * Read raw bytes (as "%c" each) with a single bounds check
+ *
+ * Returns 0 if they haven't all arrived yet: the caller should roll back and retry once
+ * more data has been read.
+ */
+int Packet_read_bytes(sockbuf_t *sbuf, char *data, int num)
+{
+    if (&sbuf->buf[sbuf->len] < &sbuf->ptr[num]) return 0;
+
+    memcpy(data, sbuf->ptr, num);
+    sbuf->ptr += num;
+
+    return num;
+}
+
+
 /*
  * Reads a packet from a socket
  *
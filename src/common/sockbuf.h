@@ -20,6 +20,7 @@
 #define SOCKBUF_LOCK        0x04    /* if locked against kernel i/o */
 #define SOCKBUF_ERROR       0x08    /* if i/o error occurred */
 #define SOCKBUF_DGRAM       0x10    /* if datagram socket */
+#define SOCKBUF_RING        0x20    /* if pending data wraps around (writing) */
 
 /*
  * Maximum number of socket i/o retries if datagram socket.
@@ -36,8 +37,14 @@ typedef struct
     char *buf;       /* i/o data buffer */
     int  size;       /* size of buffer */
     int  len;        /* amount of data in buffer (writing/reading) */
-    char *ptr;       /* current position in buffer (reading) */
+    char *ptr;       /* current position in buffer (reading) or start of pending data (ring) */
     int  state;      /* read/write/locked/error status flags */
+    void *zs;        /* stream compression state (if compressed) */
+    long zraw;       /* uncompressed bytes passed through the stream */
+    long zwire;      /* compressed bytes sent or received on the socket */
+    long nread;      /* bytes received on the socket */
+    long nsent;      /* bytes sent on the socket */
+    long nblock;     /* reads or writes the socket refused with EWOULDBLOCK/EAGAIN */
 } sockbuf_t;
 
 extern int Sockbuf_init(sockbuf_t *sbuf, int sock, int size, int state);
@@ -47,10 +54,57 @@ extern int Sockbuf_advance(sockbuf_t *sbuf, int len);
 extern int Sockbuf_rollback(sockbuf_t *sbuf, int len);
 extern int Sockbuf_flush(sockbuf_t *sbuf);
 extern int Sockbuf_write(sockbuf_t *sbuf, char *buf, int len);
+extern int Sockbuf_send(sockbuf_t *sbuf, char *buf, int len);
 extern int Sockbuf_read(sockbuf_t *sbuf);
 extern int Sockbuf_copy(sockbuf_t *dest, sockbuf_t *src, int len);
+extern int Sockbuf_compress(sockbuf_t *sbuf, int level);
+extern int Sockbuf_decompress(sockbuf_t *sbuf);
+extern int Sockbuf_backlog(sockbuf_t *sbuf);
+extern int Sockbuf_pending(sockbuf_t *sbuf);
 
 extern int Packet_printf(sockbuf_t *, char *fmt, ...);
 extern int Packet_scanf(sockbuf_t *, char *fmt, ...);
 
+/*
+ * Typed packet writers (see list-packet-layouts.h)
+ */
+#define PKW_TYPE_c  int
+#define PKW_TYPE_b  unsigned
+#define PKW_TYPE_hd int
+#define PKW_TYPE_hu unsigned
+#define PKW_TYPE_ld int32_t
+#define PKW_TYPE_lu uint32_t
+
+#define PKW0(T, N) \
+    extern int Packet_write_##N(sockbuf_t *sbuf);
+#define PKW1(T, N, A) \
+    extern int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A);
+#define PKW2(T, N, A, B) \
+    extern int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A, PKW_TYPE_##B);
+#define PKW3(T, N, A, B, C) \
+    extern int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A, PKW_TYPE_##B, PKW_TYPE_##C);
+#define PKW4(T, N, A, B, C, D) \
+    extern int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A, PKW_TYPE_##B, PKW_TYPE_##C, \
+        PKW_TYPE_##D);
+#define PKW6(T, N, A, B, C, D, E, F) \
+    extern int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A, PKW_TYPE_##B, PKW_TYPE_##C, \
+        PKW_TYPE_##D, PKW_TYPE_##E, PKW_TYPE_##F);
+#define PKB2(N, A, B) \
+    extern int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A, PKW_TYPE_##B);
+#define PKB3(N, A, B, C) \
+    extern int Packet_write_##N(sockbuf_t *sbuf, PKW_TYPE_##A, PKW_TYPE_##B, PKW_TYPE_##C);
+#include "list-packet-layouts.h"
+#undef PKW0
+#undef PKW1
+#undef PKW2
+#undef PKW3
+#undef PKW4
+#undef PKW6
+#undef PKB2
+#undef PKB3
+
+extern int Packet_write_hd_array(sockbuf_t *sbuf, const int16_t *vals, int num);
+extern int Packet_write_bytes(sockbuf_t *sbuf, const char *data, int num);
+extern int Packet_read_bytes(sockbuf_t *sbuf, char *data, int num);
+
 #endif
@@ -230,10 +230,10 @@ void square_note_spot(struct chunk *c, struct loc *grid)
     /* Paranoia */
     if (!c) return;
 
-    /* Check everyone */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check everyone on the level */
+    for (i = 0; i < chunk_roster_num(c); i++)
     {
-        struct player *p = player_get(i);
+        struct player *p = chunk_roster_get(c, i);
 
         /* Skip player if he just left the level */
         if (p->upkeep->new_level_method) continue;
@@ -280,8 +280,8 @@ void square_light_spot_aux(struct player *p, struct chunk *cv, struct loc *grid)
             p->trn_info[disp.y][disp.x].c = tc;
             p->trn_info[disp.y][disp.x].a = ta;
 
-            /* Tell client to redraw this grid */
-            Send_char(p, &disp, a, c, ta, tc);
+            /* Tell client to redraw this grid at the end of the turn */
+            Queue_char(p, &disp);
         }
     }
 }
@@ -294,13 +294,10 @@ void square_light_spot(struct chunk *c, struct loc *grid)
     /* Paranoia */
     if (!c) return;
 
-    /* Check everyone */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check everyone on the level */
+    for (i = 0; i < chunk_roster_num(c); i++)
     {
-        struct player *p = player_get(i);
-
-        /* If he's not here, skip him */
-        if (!wpos_eq(&p->wpos, &c->wpos)) continue;
+        struct player *p = chunk_roster_get(c, i);
 
         /* Actually light that spot for that player */
         square_light_spot_aux(p, c, grid);
@@ -738,13 +735,10 @@ void square_forget_all(struct chunk *c, struct loc *grid)
     /* Paranoia */
     if (!c) return;
 
-    /* Check everyone */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check everyone on the level */
+    for (i = 0; i < chunk_roster_num(c); i++)
     {
-        struct player *p = player_get(i);
-
-        /* If he's not here, skip him */
-        if (!wpos_eq(&p->wpos, &c->wpos)) continue;
+        struct player *p = chunk_roster_get(c, i);
 
         sqinfo_off(square_p(p, grid)->info, SQUARE_SEEN);
         square_forget(p, grid);
@@ -760,13 +754,10 @@ void square_forget_pile_all(struct chunk *c, struct loc *grid)
     /* Paranoia */
     if (!c) return;
 
-    /* Check everyone */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check everyone on the level */
+    for (i = 0; i < chunk_roster_num(c); i++)
     {
-        struct player *p = player_get(i);
-
-        /* If he's not here, skip him */
-        if (!wpos_eq(&p->wpos, &c->wpos)) continue;
+        struct player *p = chunk_roster_get(c, i);
 
         square_forget_pile(p, grid);
     }
@@ -1600,6 +1600,7 @@ void square_excise_object(struct chunk *c, struct loc *grid, struct object *obj)
 {
     my_assert(square_in_bounds(c, grid));
     pile_excise(&square(c, grid)->obj, obj);
+    floor_unwatch(c, obj);
 
     /* Hack -- excise object index */
     c->o_gen[0 - (obj->oidx + 1)] = false;
@@ -1639,6 +1640,7 @@ void square_excise_pile(struct chunk *c, struct loc *grid)
         preserve_artifact(obj);
 
         /* Hack -- excise object index */
+        floor_unwatch(c, obj);
         c->o_gen[0 - (obj->oidx + 1)] = false;
         obj->oidx = 0;
 
@@ -792,18 +792,15 @@ static void calc_lighting(struct player *p, struct chunk *c)
         add_light(c, p, &mon->grid, radius, light);
     }
 
-    /* Scan player list and add player lights */
-    for (k = 1; k <= NumPlayers; k++)
+    /* Scan the level roster and add player lights */
+    for (k = 0; k < chunk_roster_num(c); k++)
     {
         /* Check the k'th player */
-        struct player *q = player_get(k);
+        struct player *q = chunk_roster_get(c, k);
 
         /* Ignore the player that we're updating */
         if (q == p) continue;
 
-        /* Skip players not on this level */
-        if (!wpos_eq(&q->wpos, &p->wpos)) continue;
-
         /* Skip if the player is hidden */
         if (q->k_idx) continue;
 
@@ -348,6 +348,12 @@ void cave_free(struct chunk *c)
     mem_free(c->monster_groups);
     mem_free(c->o_gen);
     mem_free(c->join);
+    mem_free(c->roster);
+    mem_free(c->prof);
+    mem_free(c->timed_objs);
+    mem_free(c->shimmer_objs);
+    mem_free(c->wounded);
+    mem_free(c->ready);
     mem_free(c);
 }
 
@@ -116,6 +116,40 @@ struct chunk
     bool gen_hack;
 
     int profile;
+
+    /* Neighbours in the list of live levels (see chunk_list_first()) */
+    struct chunk *live_prev;
+    struct chunk *live_next;
+
+    /* Players on the level (see chunk_roster_get()) */
+    struct player **roster;
+    int roster_num;
+    int roster_size;
+
+    /* Frame profiler histograms (see prof_summarize()) */
+    struct prof_hist *prof;
+
+    /* Game turn the level went dormant, zero if awake */
+    hturn dormant_turn;
+
+    /* Floor objects with a timeout, and shimmering floor objects (see floor_watch()) */
+    struct object **timed_objs;
+    int timed_num;
+    int timed_size;
+    struct object **shimmer_objs;
+    int shimmer_num;
+    int shimmer_size;
+
+    /* Monsters below their max HP (see monster_note_wounded()) */
+    int *wounded;
+    int wounded_num;
+    int wounded_size;
+
+    /* Monsters with enough energy to act, in processing order (see process_monsters()) */
+    int *ready;
+    int ready_num;
+    int ready_size;
+    bool ready_stale;
 };
 
 /*
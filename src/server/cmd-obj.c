@@ -1450,9 +1450,12 @@ static bool do_cmd_use_end(struct player *p, struct object *obj, bool ident, boo
             {
                 obj->timeout += randcalc(obj->time, 0, RANDOMISE);
 
-                /* Redraw */
+                /* Recharge and redraw */
                 if (!object_is_carried(p, obj))
+                {
+                    floor_watch_timeout(chunk_get(&p->wpos), obj);
                     redraw_floor(&p->wpos, &obj->grid, obj);
+                }
             }
 
             /* Other activatable items */
@@ -42,9 +42,13 @@ static void console_who(int ind, char *dummy);
 static void console_debug(int ind, char *dummy);
 static void console_listen(int ind, char *channel);
 static void console_whois(int ind, char *name);
+static void console_watch(int ind, char *name);
 static void console_message(int ind, char *buf);
 static void console_kick_player(int ind, char *name);
 static void console_rng_test(int ind, char *dummy);
+static void console_timer(int ind, char *dummy);
+static void console_profile(int ind, char *what);
+static void console_traffic(int ind, char *name);
 static void console_reload(int ind, char *mod);
 static void console_shutdown(int ind, char *dummy);
 static void console_wrath(int ind, char *name);
@@ -62,7 +66,11 @@ static console_command_ops console_commands[] =
     {"wrath", console_wrath, 1, "PLAYERNAME\nDelete (cheating) player from the game"},
     {"reload", console_reload, 1, "config|news\nReload mangband.cfg or news.txt"},
     {"whois", console_whois, 1, "PLAYERNAME\nDetailed player information"},
+    {"watch", console_watch, 0, "[PLAYERNAME]\nWatch the map of a player, or stop watching"},
     {"rngtest", console_rng_test, 0, "\nPerform RNG test"},
+    {"timer", console_timer, 0, "\nGame clock statistics"},
+    {"profile", console_profile, 0, "[levels|reset]\nFrame time of each game loop phase, or of each level"},
+    {"traffic", console_traffic, 0, "[PLAYERNAME]\nNetwork statistics of a player, or of all"},
     {"debug", console_debug, 0, "\nUnused"}
 };
 
@@ -376,8 +384,10 @@ static void console_whois(int ind, char *name)
     char brave[30];
     const char *batty = "";
     char *entry;
+    connection_t *connp;
     sockbuf_t *console_buf_w = (sockbuf_t*)console_buffer(ind, CONSOLE_WRITE);
     char terminator = '\n';
+    struct in_addr addr;
 
     /* Find this player */
     for (i = 1; i <= NumPlayers; i++)
@@ -417,6 +427,31 @@ static void console_whois(int ind, char *name)
     Packet_printf(console_buf_w, "%S", format("(%s@%s [%s] v%d.%d.%d.%d)\n", p->full_name,
         p->hostname, p->addr, major, minor, patch, extra));
 
+    /* Hostname looked up from the address, if the helper has answered since the login */
+    connp = get_connection(p->conn);
+    addr.s_addr = inet_addr(p->addr);
+    if (streq(connp->resolved, p->addr))
+        SLLookupName(addr, connp->resolved, sizeof(connp->resolved));
+    if (!streq(connp->resolved, p->addr))
+        Packet_printf(console_buf_w, "%s", format("Resolved host: %s\n", connp->resolved));
+
+    /* Stream compression ratio */
+    if (connp->w.zraw)
+    {
+        Packet_printf(console_buf_w, "%s", format("Stream compressed to %ld%% (%ld of %ld bytes)\n",
+            connp->w.zwire * 100 / connp->w.zraw, connp->w.zwire, connp->w.zraw));
+    }
+    if (connp->status.suppressed)
+    {
+        Packet_printf(console_buf_w, "%s", format("Unchanged status packets dropped: %ld\n",
+            connp->status.suppressed));
+    }
+    if (connp->status.deferred)
+    {
+        Packet_printf(console_buf_w, "%s", format("Status packets held back: %ld\n",
+            connp->status.deferred));
+    }
+
     /* Other interesting factoids */
     if (p->lives > 0)
         Packet_printf(console_buf_w, "%s", format("Has resurrected %d times.\n", p->lives));
@@ -438,6 +473,41 @@ static void console_whois(int ind, char *name)
 }
 
 
+/*
+ * Watch the map of a player as text
+ */
+static void console_watch(int ind, char *name)
+{
+    int i, len;
+    struct player *p = NULL, *p_ptr_search;
+    sockbuf_t *console_buf_w = (sockbuf_t*)console_buffer(ind, CONSOLE_WRITE);
+    char terminator = '\n';
+
+    /* Stop watching */
+    if (!name)
+    {
+        Conn_watch(ind, NULL);
+        Packet_printf(console_buf_w, "%s%c", "Stopped watching", (int)terminator);
+        Sockbuf_flush(console_buf_w);
+        return;
+    }
+
+    /* Find this player */
+    for (i = 1; i <= NumPlayers; i++)
+    {
+        p_ptr_search = player_get(i);
+        len = strlen(p_ptr_search->name);
+        if (!my_strnicmp(p_ptr_search->name, name, len))
+            p = p_ptr_search;
+    }
+    if (!p || !Conn_watch(ind, p))
+    {
+        Packet_printf(console_buf_w, "%s%c", "No such player", (int)terminator);
+        Sockbuf_flush(console_buf_w);
+    }
+}
+
+
 static void console_message(int ind, char *buf)
 {
     /* Send the message */
@@ -526,6 +596,213 @@ static void console_rng_test(int ind, char *dummy)
 }
 
 
+/*
+ * Report how well the game loop keeps up with the game clock
+ */
+static void console_timer(int ind, char *dummy)
+{
+    sockbuf_t *console_buf_w = (sockbuf_t*)console_buffer(ind, CONSOLE_WRITE);
+    struct timer_stats stats;
+
+    get_timer_stats(&stats);
+
+    Packet_printf(console_buf_w, "%s", format("%ld frames at %d fps\n", stats.frames, cfg_fps));
+    Packet_printf(console_buf_w, "%s", format("%ld overruns, %ld ticks dropped\n",
+        stats.overruns, stats.dropped));
+    Packet_printf(console_buf_w, "%s", format("Tick lateness: %ld usec average, %ld usec max\n",
+        (stats.frames? stats.late_total / stats.frames: 0), stats.late_max));
+    Sockbuf_flush(console_buf_w);
+}
+
+
+/*
+ * Report the time spent in each phase of the game loop over the last minutes (whole frames), or
+ * for each level
+ */
+static void console_profile(int ind, char *what)
+{
+    sockbuf_t *console_buf_w = (sockbuf_t*)console_buffer(ind, CONSOLE_WRITE);
+    struct prof_summary sum;
+    struct chunk *c;
+    int i;
+
+    if (what && !strcmp(what, "reset"))
+    {
+        prof_reset();
+        Packet_printf(console_buf_w, "%s", "Profiles reset\n");
+        Sockbuf_flush(console_buf_w);
+        return;
+    }
+
+    /* Whole frames */
+    if (!what || strcmp(what, "levels"))
+    {
+        prof_summarize(NULL, PROF_FRAME, &sum);
+        Packet_printf(console_buf_w, "%s", format("%ld frames (usec per frame)\n", sum.samples));
+        Packet_printf(console_buf_w, "%s", format("  %-12s %8s %8s %8s\n", "Phase", "p50",
+            "p99", "max"));
+        for (i = 0; i < PROF_MAX; i++)
+        {
+            prof_summarize(NULL, i, &sum);
+            Packet_printf(console_buf_w, "%s", format("  %-12s %8ld %8ld %8ld\n",
+                prof_phase_names[i], sum.p50, sum.p99, sum.max));
+        }
+        Sockbuf_flush(console_buf_w);
+        return;
+    }
+
+    /* Each level */
+    Packet_printf(console_buf_w, "%s", "Levels (usec per call)\n");
+    for (c = chunk_list_first(); c; c = c->live_next)
+    {
+        Packet_printf(console_buf_w, "%s", format("%dft at (%d, %d)\n", c->wpos.depth * 50,
+            c->wpos.grid.x, c->wpos.grid.y));
+        for (i = 0; i < PROF_MAX; i++)
+        {
+            prof_summarize(c, i, &sum);
+            if (!sum.samples) continue;
+            Packet_printf(console_buf_w, "%s",
+                format("  %-12s %6ld calls, p50 %ld, p99 %ld, max %ld\n", prof_phase_names[i],
+                sum.samples, sum.p50, sum.p99, sum.max));
+        }
+        Sockbuf_flush(console_buf_w);
+    }
+}
+
+
+/*
+ * Packet names, for the traffic statistics
+ */
+static const char *packet_names[] =
+{
+    #define PKT(a, b, c, d, e) #a,
+    #include "../common/list-packets.h"
+    #undef PKT
+    NULL
+};
+
+
+/*
+ * Sort packet types by decreasing bandwidth
+ */
+static const struct conn_traffic *traffic_sorted;
+
+
+static int cmp_traffic(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    long bx = traffic_sorted->bytes_in[x] + traffic_sorted->bytes_out[x];
+    long by = traffic_sorted->bytes_in[y] + traffic_sorted->bytes_out[y];
+
+    if (bx != by) return ((bx < by)? 1: -1);
+    return x - y;
+}
+
+
+/*
+ * Print traffic statistics
+ */
+static void console_traffic_print(sockbuf_t *console_buf_w, const char *who,
+    const struct conn_traffic *traffic, bool details)
+{
+    long bytes_in = 0, bytes_out = 0, pkts_in = 0, pkts_out = 0;
+    int types[PKT_MAX], num = 0, i;
+
+    for (i = 0; i < PKT_MAX; i++)
+    {
+        bytes_in += traffic->bytes_in[i];
+        bytes_out += traffic->bytes_out[i];
+        pkts_in += traffic->pkts_in[i];
+        pkts_out += traffic->pkts_out[i];
+        if (traffic->pkts_in[i] || traffic->pkts_out[i]) types[num++] = i;
+    }
+
+    Packet_printf(console_buf_w, "%s",
+        format("%s: %ld packets (%ld bytes) in, %ld packets (%ld bytes) out\n", who, pkts_in,
+        bytes_in, pkts_out, bytes_out));
+    Packet_printf(console_buf_w, "%s",
+        format("  Socket: %ld bytes in, %ld bytes out, %ld EAGAIN, %ld stalls\n",
+        traffic->wire_in, traffic->wire_out, traffic->blocked, traffic->stalls));
+    Packet_printf(console_buf_w, "%s", format("  Deepest queues: c %d, q %d, w %d\n",
+        traffic->max_c, traffic->max_q, traffic->max_w));
+    Packet_printf(console_buf_w, "%s",
+        format("  Latency: %ld commands, %ld usec average, %ld usec max\n", traffic->replies,
+        (long)(traffic->replies? traffic->latency / traffic->replies: 0), traffic->max_latency));
+
+    if (!details) return;
+
+    /* Busiest packet types first */
+    traffic_sorted = traffic;
+    sort(types, num, sizeof(int), cmp_traffic);
+    Packet_printf(console_buf_w, "%s", format("  %-20s %8s %10s %8s %10s %5s\n", "Packet", "In",
+        "Bytes", "Out", "Bytes", "Share"));
+    for (i = 0; i < num; i++)
+    {
+        int type = types[i];
+        long bytes = traffic->bytes_in[type] + traffic->bytes_out[type];
+
+        Packet_printf(console_buf_w, "%s", format("  %-20s %8ld %10ld %8ld %10ld %4ld%%\n",
+            packet_names[type], traffic->pkts_in[type], traffic->bytes_in[type],
+            traffic->pkts_out[type], traffic->bytes_out[type],
+            bytes * 100 / MAX(bytes_in + bytes_out, 1)));
+    }
+}
+
+
+/*
+ * Network statistics of a player (with the current queue depths), or of all players since the
+ * server started
+ */
+static void console_traffic(int ind, char *name)
+{
+    int i, len;
+    struct player *p = NULL, *p_ptr_search;
+    connection_t *connp;
+    sockbuf_t *console_buf_w = (sockbuf_t*)console_buffer(ind, CONSOLE_WRITE);
+    struct conn_traffic traffic;
+    char terminator = '\n';
+
+    /* All players */
+    if (!name)
+    {
+        for (i = 1; i <= NumPlayers; i++)
+        {
+            p = player_get(i);
+            Conn_get_traffic(p->conn, &traffic);
+            console_traffic_print(console_buf_w, p->name, &traffic, false);
+        }
+        Conn_get_traffic_total(&traffic);
+        console_traffic_print(console_buf_w, "Total", &traffic, true);
+        Sockbuf_flush(console_buf_w);
+        return;
+    }
+
+    /* Find this player */
+    for (i = 1; i <= NumPlayers; i++)
+    {
+        p_ptr_search = player_get(i);
+        len = strlen(p_ptr_search->name);
+        if (!my_strnicmp(p_ptr_search->name, name, len))
+            p = p_ptr_search;
+    }
+    if (!p)
+    {
+        Packet_printf(console_buf_w, "%s%c", "No such player", (int)terminator);
+        Sockbuf_flush(console_buf_w);
+        return;
+    }
+
+    /* Current queue depths */
+    connp = get_connection(p->conn);
+    Packet_printf(console_buf_w, "%s", format("Queues: c %d, q %d, w %d\n", connp->c.len,
+        connp->q.len, Sockbuf_pending(&connp->w)));
+
+    Conn_get_traffic(p->conn, &traffic);
+    console_traffic_print(console_buf_w, p->name, &traffic, true);
+    Sockbuf_flush(console_buf_w);
+}
+
+
 static void console_reload(int ind, char *mod)
 {
     sockbuf_t *console_buf_w = (sockbuf_t*)console_buffer(ind, CONSOLE_WRITE);
@@ -542,9 +819,7 @@ static void console_reload(int ind, char *mod)
     else if (streq(mod, "news"))
     {
         /* Reload the news file */
-        Init_setup();
-
-        done = true;
+        if (Init_setup() == 0) done = true;
     }
 
     /* Let mangconsole know that the command was a success */
@@ -2559,11 +2559,10 @@ static int base_time_factor(struct player *p, struct chunk *c, int slowest)
     if (!p) return NORMAL_TIME;
 
     /* If this is the initial call, reset time bubble check for all players on the level */
-    for (i = 1; !slowest && (i <= NumPlayers); i++)
+    for (i = 0; !slowest && (i < chunk_roster_num(c)); i++)
     {
-        struct player *q = player_get(i);
+        struct player *q = chunk_roster_get(c, i);
 
-        if (!wpos_eq(&q->wpos, &p->wpos)) continue;
         q->bubble_checked = false;
     }
 
@@ -2611,14 +2610,11 @@ static int base_time_factor(struct player *p, struct chunk *c, int slowest)
     p->bubble_checked = true;
 
     /* Check all other players within our range */
-    for (i = 1; i <= NumPlayers; i++)
+    for (i = 0; i < chunk_roster_num(c); i++)
     {
-        struct player *q = player_get(i);
+        struct player *q = chunk_roster_get(c, i);
         int dist;
 
-        /* Skip him if he's on a different dungeon level */
-        if (!wpos_eq(&q->wpos, &p->wpos)) continue;
-
         /* Only check them if they haven't already been checked */
         if (q->bubble_checked) continue;
 
@@ -2644,7 +2640,7 @@ static int base_time_factor(struct player *p, struct chunk *c, int slowest)
  *
  * This is a simplified version of base_time_factor() without concern for monsters or health.
  */
-static int base_time_factor_simple(struct player *p, int slowest)
+static int base_time_factor_simple(struct player *p, struct chunk *c, int slowest)
 {
     int i, timefactor;
 
@@ -2652,11 +2648,10 @@ static int base_time_factor_simple(struct player *p, int slowest)
     if (!p) return NORMAL_TIME;
 
     /* If this is the initial call, reset time bubble check for all players on the level */
-    for (i = 1; !slowest && (i <= NumPlayers); i++)
+    for (i = 0; !slowest && (i < chunk_roster_num(c)); i++)
     {
-        struct player *q = player_get(i);
+        struct player *q = chunk_roster_get(c, i);
 
-        if (!wpos_eq(&q->wpos, &p->wpos)) continue;
         q->bubble_checked = false;
     }
 
@@ -2676,14 +2671,11 @@ static int base_time_factor_simple(struct player *p, int slowest)
     p->bubble_checked = true;
 
     /* Check all other players within our range */
-    for (i = 1; i <= NumPlayers; i++)
+    for (i = 0; i < chunk_roster_num(c); i++)
     {
-        struct player *q = player_get(i);
+        struct player *q = chunk_roster_get(c, i);
         int dist;
 
-        /* Skip him if he's on a different dungeon level */
-        if (!wpos_eq(&q->wpos, &p->wpos)) continue;
-
         /* Only check them if they haven't already been checked */
         if (q->bubble_checked) continue;
 
@@ -2694,7 +2686,7 @@ static int base_time_factor_simple(struct player *p, int slowest)
         if (dist > z_info->max_sight) continue;
 
         /* Find the slowest time bubble chain we are part of */
-        slowest = base_time_factor_simple(q, timefactor);
+        slowest = base_time_factor_simple(q, c, timefactor);
 
         /* Use the slowest time bubble */
         if (slowest < timefactor) timefactor = slowest;
@@ -2710,16 +2702,59 @@ static int base_time_factor_simple(struct player *p, int slowest)
 int time_factor(struct player *p, struct chunk *c)
 {
     /* Paranoia */
-    if (!p) return NORMAL_TIME;
+    if (!p || !c) return NORMAL_TIME;
 
     /* Use basic time scaling in towns */
-    if (in_town(&p->wpos)) return base_time_factor_simple(p, 0);
+    if (in_town(&p->wpos)) return base_time_factor_simple(p, c, 0);
 
     /* Scale our time by our bubbles time factor */
     return base_time_factor(p, c, 0);
 }
 
 
+/*
+ * Same as monsters_in_los(), but only checked once per game turn.
+ *
+ * Every monster on the level asks this about its closest player each turn. The master of a
+ * controlled monster may be on another level: the answer is then not kept.
+ */
+bool turn_monsters_in_los(struct player *p, struct chunk *c)
+{
+    if (!wpos_eq(&p->wpos, &c->wpos)) return monsters_in_los(p, c);
+
+    if (ht_cmp(&p->in_los_turn, &turn))
+    {
+        p->in_los = monsters_in_los(p, c);
+        ht_copy(&p->in_los_turn, &turn);
+    }
+
+    return p->in_los;
+}
+
+
+/*
+ * Same as time_factor(), but only computed once per game turn.
+ *
+ * Every monster on the level asks this about its closest player each turn. The master of a
+ * controlled monster may be on another level: the time factor is then not kept.
+ */
+int turn_time_factor(struct player *p, struct chunk *c)
+{
+    /* Paranoia */
+    if (!p || !c) return NORMAL_TIME;
+
+    if (!wpos_eq(&p->wpos, &c->wpos)) return time_factor(p, c);
+
+    if (ht_cmp(&p->timefactor_turn, &turn))
+    {
+        p->timefactor = time_factor(p, c);
+        ht_copy(&p->timefactor_turn, &turn);
+    }
+
+    return p->timefactor;
+}
+
+
 /*
  * Dungeon master commands
  */
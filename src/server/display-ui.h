@@ -50,6 +50,8 @@ extern void center_panel(struct player *p);
 extern int move_energy(int depth);
 extern bool monsters_in_los(struct player *p, struct chunk *c);
 extern int time_factor(struct player *p, struct chunk *c);
+extern bool turn_monsters_in_los(struct player *p, struct chunk *c);
+extern int turn_time_factor(struct player *p, struct chunk *c);
 extern int pick_arena(struct worldpos *wpos, struct loc *grid);
 extern void access_arena(struct player *p, struct loc *grid);
 extern void describe_player(struct player *p, struct player *q);
@@ -1604,6 +1604,7 @@ bool effect_handler_EARTHQUAKE(effect_handler_context_t *context)
 
                     /* Apply damage directly */
                     mon->hp -= m_dam;
+                    monster_note_wounded(context->cave, mon);
 
                     /* Delete (not kill) "dead" monsters */
                     if (mon->hp < 0)
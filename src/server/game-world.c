@@ -1167,50 +1167,34 @@ static void on_new_level(void)
  */
 static void on_leave_level(void)
 {
-    int i;
-    struct loc grid;
+    struct chunk *c, *next;
 
     /* Deallocate any unused levels */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+    for (c = chunk_list_first(); c; c = next)
     {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-        {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
-
-            /* Caves */
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
-            {
-                if (!w_ptr->chunk_list[i]) continue;
+        next = c->live_next;
 
-                /* Don't deallocate special levels */
-                if (level_keep_allocated(w_ptr->chunk_list[i])) continue;
+        /* Don't deallocate special levels */
+        if (level_keep_allocated(c)) continue;
 
-                /* Hack -- deallocate custom houses */
-                wipe_custom_houses(&w_ptr->chunk_list[i]->wpos);
+        /* Hack -- deallocate custom houses */
+        wipe_custom_houses(&c->wpos);
 
-                /* Deallocate the level */
-                cave_wipe(w_ptr->chunk_list[i]);
-                w_ptr->chunk_list[i] = NULL;
-            }
-        }
+        /* Deallocate the level */
+        chunk_list_remove(c);
+        cave_wipe(c);
     }
 }
 
 
 static struct chunk *get_location(struct monster_race *race)
 {
-    struct loc grid;
+    struct chunk *c;
 
     /* Get location */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+    for (c = chunk_list_first(); c; c = c->live_next)
     {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-        {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
-            struct chunk *c = w_ptr->chunk_list[0];
-
-            if (c && allow_location(race, &c->wpos)) return c;
-        }
+        if (!c->wpos.depth && allow_location(race, &c->wpos)) return c;
     }
 
     return NULL;
@@ -1317,25 +1301,19 @@ static void process_various(void)
     /* Grow crops very occasionally */
     if (!(turn.turn % (10L * GROW_CROPS)))
     {
-        struct loc grid;
+        struct chunk *c;
 
         /* For each wilderness level */
-        for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+        for (c = chunk_list_first(); c; c = c->live_next)
         {
-            for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-            {
-                struct wild_type *w_ptr = get_wt_info_at(&grid);
-                struct chunk *c = w_ptr->chunk_list[0];
-                struct loc begin, end;
+            struct loc begin, end;
 
-                /* Must exist */
-                if (!c) continue;
+            if (c->wpos.depth) continue;
 
-                loc_init(&begin, 0, 0);
-                loc_init(&end, c->width, c->height);
+            loc_init(&begin, 0, 0);
+            loc_init(&end, c->width, c->height);
 
-                wild_grow_crops(c, &begin, &end, true);
-            }
+            wild_grow_crops(c, &begin, &end, true);
         }
     }
 
@@ -1823,7 +1801,7 @@ static void energize_player(struct player *p)
 {
     int energy;
     struct chunk *c = chunk_get(&p->wpos);
-    bool allow_running = (in_town(&c->wpos) || !monsters_in_los(p, c));
+    bool allow_running = (in_town(&c->wpos) || !turn_monsters_in_los(p, c));
 
     /* Player is idle */
     bool is_idle = has_energy(p, false);
@@ -1839,7 +1817,7 @@ static void energize_player(struct player *p)
     energy = frame_energy(p->state.speed);
 
     /* Scale depending upon our time bubble */
-    energy = energy * time_factor(p, c) / 100;
+    energy = energy * turn_time_factor(p, c) / 100;
 
     /* Running speeds up time */
     if (p->upkeep->running && allow_running) energy = energy * RUNNING_FACTOR / 100;
@@ -1872,12 +1850,35 @@ static void energize_player(struct player *p)
 
 
 /*
- * Give monsters some energy.
+ * Net speed of a monster
+ */
+static int monster_net_speed(struct monster *mon)
+{
+    int mspeed = mon->mspeed;
+
+    if (mon->m_timed[MON_TMD_FAST])
+        mspeed += 10;
+    if (mon->m_timed[MON_TMD_SLOW])
+    {
+        int slow_level = monster_effect_level(mon, MON_TMD_SLOW);
+
+        mspeed -= (2 * slow_level);
+    }
+
+    return mspeed;
+}
+
+
+/*
+ * Give monsters some energy, and queue those which have enough to act next turn.
  */
 static void energize_monsters(struct chunk *c)
 {
     int i;
-    int mspeed, energy;
+    int energy;
+
+    c->ready_num = 0;
+    c->ready_stale = false;
 
     /* Process the monsters (backwards) */
     for (i = cave_monster_max(c) - 1; i >= 1; i--)
@@ -1891,26 +1892,16 @@ static void energize_monsters(struct chunk *c)
         /* Skip "unconscious" monsters */
         if (mon->hp == 0) continue;
 
-        /* Calculate the net speed */
-        mspeed = mon->mspeed;
-        if (mon->m_timed[MON_TMD_FAST])
-            mspeed += 10;
-        if (mon->m_timed[MON_TMD_SLOW])
-        {
-            int slow_level = monster_effect_level(mon, MON_TMD_SLOW);
-
-            mspeed -= (2 * slow_level);
-        }
-
         /* Obtain the energy boost */
-        energy = frame_energy(mspeed);
+        energy = frame_energy(monster_net_speed(mon));
 
         /* If we are within a player's time bubble, scale our energy */
         if (mon->closest_player)
         {
-            bool allow_running = (!in_town(&c->wpos) && !monsters_in_los(mon->closest_player, c));
+            bool allow_running = (!in_town(&c->wpos) &&
+                !turn_monsters_in_los(mon->closest_player, c));
 
-            energy = energy * time_factor(mon->closest_player, c) / 100;
+            energy = energy * turn_time_factor(mon->closest_player, c) / 100;
 
             /* Speed up time if the player is running, except in town */
             if (mon->closest_player->upkeep->running && allow_running)
@@ -1923,38 +1914,377 @@ static void energize_monsters(struct chunk *c)
             /* Give this monster some energy */
             mon->energy += energy;
         }
+
+        /* Ready to act */
+        if (mon->energy >= move_energy(mon->wpos.depth)) queue_monster(c, mon);
     }
 }
 
 
 /*
- * Pre-turn game loop.
+ * Number of the "num" turns from "first" on which (turn % 10) == "phase"
  */
-static void pre_turn_game_loop(void)
+static uint32_t count_phase_turns(uint32_t first, uint32_t num, uint32_t phase)
+{
+    uint32_t skip = (phase + 10 - first % 10) % 10;
+
+    if (skip >= num) return 0;
+    return 1 + (num - 1 - skip) / 10;
+}
+
+
+/*
+ * Catch up with "num" game turns (from "first") skipped while the level was dormant.
+ *
+ * Without players on the level, monsters don't act and only gain energy, and the objects and
+ * traps only see their timeouts run.
+ */
+static void wake_level(struct chunk *c, uint32_t first, uint32_t num)
 {
+    uint32_t ticks = count_phase_turns(first, num, 5);
+    struct loc begin, end;
+    struct loc_iterator iter;
     int i;
-    struct loc grid;
 
-    on_new_level();
+    /* Give energy to the monsters, as energize_monsters() would have done each turn */
+    for (i = cave_monster_max(c) - 1; i >= 1; i--)
+    {
+        struct monster *mon = cave_monster(c, i);
+        int energy, needed;
+        uint32_t steps;
 
-    /* Handle any network stuff */
-    Net_input();
+        if (!mon->race || (mon->hp == 0)) continue;
 
-    /* Process monsters with even more energy first */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+        energy = frame_energy(monster_net_speed(mon));
+        needed = move_energy(mon->wpos.depth) - mon->energy;
+        if ((energy <= 0) || (needed <= 0)) continue;
+
+        /* Energy stops accumulating once the monster can move */
+        steps = (needed + energy - 1) / energy;
+        mon->energy += energy * MIN(steps, num);
+    }
+
+    /* Monsters may have become ready to act */
+    c->ready_stale = true;
+
+    /* Run the object timeouts, as process_objects() would have done every ten turns */
+    for (i = c->timed_num - 1; ticks && (i >= 0); i--)
     {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
+        struct object *obj = c->timed_objs[i];
+        uint32_t k;
+
+        /* Recharge rods */
+        if (tval_can_have_timeout(obj))
         {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
+            for (k = 0; (k < ticks) && obj->timeout; k++) recharge_timeout(obj);
+            if (!obj->timeout) floor_watch_timeout(c, obj);
+        }
 
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
+        /* Corpses slowly decompose */
+        if (tval_is_corpse(obj))
+        {
+            if ((uint32_t)obj->decay <= ticks)
             {
-                struct chunk *c = w_ptr->chunk_list[i];
+                struct loc grid;
 
-                if (c) process_monsters(c, true);
+                loc_copy(&grid, &obj->grid);
+                square_delete_object(c, &grid, obj, false, false);
             }
+            else
+                obj->decay -= ticks;
+        }
+    }
+
+    /* Run the trap timeouts, as process_world() would have done every ten turns */
+    ticks = count_phase_turns(first, num, 0);
+    loc_init(&begin, 1, 1);
+    loc_init(&end, c->width, c->height);
+    loc_iterator_first(&iter, &begin, &end);
+    do
+    {
+        struct trap *trap;
+
+        for (trap = square(c, &iter.cur)->trap; ticks && trap; trap = trap->next)
+            trap->timeout -= MIN(trap->timeout, ticks);
+    }
+    while (loc_iterator_next_strict(&iter));
+}
+
+
+static bool level_dormant(struct chunk *c)
+{
+    return !ht_zero(&c->dormant_turn);
+}
+
+
+/*
+ * Put the levels without players to sleep, and wake up those where players have arrived.
+ *
+ * Levels kept in memory without players (towns, levels with houses...) don't need to run every
+ * turn: they go dormant and catch up in one step when a player arrives. Levels with controlled
+ * monsters stay awake, since those monsters follow their master even from another level.
+ */
+static void update_dormant_levels(void)
+{
+    struct chunk *c;
+
+    for (c = chunk_list_first(); c; c = c->live_next)
+    {
+        bool dormant = !chunk_roster_num(c);
+        int i;
+
+        for (i = 1; dormant && !level_dormant(c) && (i < cave_monster_max(c)); i++)
+        {
+            if (cave_monster(c, i)->master) dormant = false;
+        }
+
+        /* Go dormant */
+        if (dormant && !level_dormant(c)) ht_copy(&c->dormant_turn, &turn);
+
+        /* Wake up */
+        else if (!dormant && level_dormant(c))
+        {
+            wake_level(c, c->dormant_turn.turn, ht_diff(&turn, &c->dormant_turn));
+            ht_reset(&c->dormant_turn);
         }
     }
+}
+
+
+/*
+ * Frame profiler
+ *
+ * Each phase of the game loop is timed with the monotonic clock. For the whole server, a sample
+ * is the time spent in a phase during one frame; for a level, it is the time spent in one call
+ * for that level. Samples go into histograms with four buckets per power of two, which cover
+ * the current window of PROF_WINDOW seconds and the previous one.
+ */
+#define PROF_BUCKETS    128
+#define PROF_WINDOW     60
+
+struct prof_hist
+{
+    uint32_t epoch;                     /* Window of the last sample */
+    uint32_t count[2][PROF_BUCKETS];    /* Samples per bucket, for the last two windows */
+    long max[2];                        /* Worst sample, for the last two windows */
+};
+
+
+const char *prof_phase_names[PROF_MAX] =
+{
+    "player", "monsters", "objects", "world", "refresh", "net input", "net output", "new level",
+    "various", "frame"
+};
+
+
+static struct prof_hist prof_frames[PROF_MAX];
+static long prof_frame_usec[PROF_MAX];
+static uint32_t prof_epoch = 2;
+static int prof_window_frames = 0;
+static int prof_worst_phase;
+static long prof_worst_usec = 0;
+static struct worldpos prof_worst_wpos;
+
+
+static int prof_bucket(long usec)
+{
+    int h = 2;
+
+    if (usec < 4) return (int)MAX(usec, 0);
+    while (usec >> (h + 1)) h++;
+
+    return MIN(4 * (h - 1) + (int)((usec >> (h - 2)) & 3), PROF_BUCKETS - 1);
+}
+
+
+/*
+ * Upper bound of a bucket
+ */
+static long prof_bucket_usec(int b)
+{
+    int h = b / 4 + 1;
+
+    if (b < 4) return b;
+
+    return ((long)(5 + b % 4) << (h - 2)) - 1;
+}
+
+
+static bool prof_window_valid(struct prof_hist *hist, int w)
+{
+    if (hist->epoch == prof_epoch) return true;
+    return ((hist->epoch + 1 == prof_epoch) && (w == (int)(hist->epoch & 1)));
+}
+
+
+static void prof_sample(struct prof_hist *hist, long usec)
+{
+    int w = prof_epoch & 1;
+
+    /* Start a new window, forgetting anything older than the previous one */
+    if (hist->epoch != prof_epoch)
+    {
+        if (hist->epoch + 1 != prof_epoch)
+        {
+            memset(hist->count[!w], 0, sizeof(hist->count[!w]));
+            hist->max[!w] = 0;
+        }
+        memset(hist->count[w], 0, sizeof(hist->count[w]));
+        hist->max[w] = 0;
+        hist->epoch = prof_epoch;
+    }
+
+    hist->count[w][prof_bucket(usec)]++;
+    if (usec > hist->max[w]) hist->max[w] = usec;
+}
+
+
+/*
+ * Time spent since "start" in a phase, for the given level if any
+ */
+static void prof_add(int phase, struct chunk *c, long long start)
+{
+    long usec = (long)(get_clock_usec() - start);
+
+    prof_frame_usec[phase] += usec;
+    if (!c) return;
+
+    if (!c->prof) c->prof = mem_zalloc(PROF_MAX * sizeof(struct prof_hist));
+    prof_sample(&c->prof[phase], usec);
+
+    /* Remember the worst call of the frame */
+    if (usec > prof_worst_usec)
+    {
+        prof_worst_usec = usec;
+        prof_worst_phase = phase;
+        memcpy(&prof_worst_wpos, &c->wpos, sizeof(struct worldpos));
+    }
+}
+
+
+/*
+ * Record the phases of a frame which started at "start", and log it if it was slow
+ */
+static void prof_frame_end(long long start)
+{
+    int i, slowest = 0;
+
+    prof_frame_usec[PROF_FRAME] = (long)(get_clock_usec() - start);
+    for (i = 0; i < PROF_MAX; i++)
+    {
+        prof_sample(&prof_frames[i], prof_frame_usec[i]);
+        if ((i != PROF_FRAME) && (prof_frame_usec[i] > prof_frame_usec[slowest])) slowest = i;
+    }
+
+    if (cfg_slow_frame_log && (prof_frame_usec[PROF_FRAME] >= cfg_slow_frame_log * 1000L))
+    {
+        if (prof_worst_usec)
+        {
+            plog_fmt("Slow frame: %ld usec, %s %ld usec, worst %s %ld usec %dft at (%d, %d)",
+                prof_frame_usec[PROF_FRAME], prof_phase_names[slowest], prof_frame_usec[slowest],
+                prof_phase_names[prof_worst_phase], prof_worst_usec, prof_worst_wpos.depth * 50,
+                prof_worst_wpos.grid.x, prof_worst_wpos.grid.y);
+        }
+        else
+        {
+            plog_fmt("Slow frame: %ld usec, %s %ld usec", prof_frame_usec[PROF_FRAME],
+                prof_phase_names[slowest], prof_frame_usec[slowest]);
+        }
+    }
+
+    memset(prof_frame_usec, 0, sizeof(prof_frame_usec));
+    prof_worst_usec = 0;
+
+    /* Start a new window */
+    if (++prof_window_frames >= cfg_fps * PROF_WINDOW)
+    {
+        prof_window_frames = 0;
+        prof_epoch++;
+    }
+}
+
+
+/*
+ * Get the profile of a phase over the last one or two windows, for the given level or (if "c"
+ * is NULL) for whole frames
+ */
+void prof_summarize(struct chunk *c, int phase, struct prof_summary *sum)
+{
+    struct prof_hist *hist = (c? (c->prof? &c->prof[phase]: NULL): &prof_frames[phase]);
+    long seen = 0;
+    int w, b;
+    bool median = false;
+
+    memset(sum, 0, sizeof(*sum));
+    if (!hist) return;
+
+    for (w = 0; w < 2; w++)
+    {
+        if (!prof_window_valid(hist, w)) continue;
+        for (b = 0; b < PROF_BUCKETS; b++) sum->samples += hist->count[w][b];
+        sum->max = MAX(sum->max, hist->max[w]);
+    }
+
+    for (b = 0; b < PROF_BUCKETS; b++)
+    {
+        for (w = 0; w < 2; w++)
+        {
+            if (prof_window_valid(hist, w)) seen += hist->count[w][b];
+        }
+        if (!median && (seen * 2 >= sum->samples))
+        {
+            sum->p50 = prof_bucket_usec(b);
+            median = true;
+        }
+        if (seen * 100 >= sum->samples * 99)
+        {
+            sum->p99 = MIN(prof_bucket_usec(b), sum->max);
+            break;
+        }
+    }
+    sum->p50 = MIN(sum->p50, sum->max);
+}
+
+
+/*
+ * Forget all profiles
+ */
+void prof_reset(void)
+{
+    memset(prof_frames, 0, sizeof(prof_frames));
+
+    /* Level profiles are now two windows old */
+    prof_epoch += 2;
+    prof_window_frames = 0;
+}
+
+
+/*
+ * Pre-turn game loop.
+ */
+static void pre_turn_game_loop(void)
+{
+    struct chunk *c;
+    long long start;
+
+    on_new_level();
+
+    /* Handle any network stuff */
+    start = get_clock_usec();
+    Net_input();
+    prof_add(PROF_NET_INPUT, NULL, start);
+
+    /* Put the levels without players to sleep */
+    update_dormant_levels();
+
+    /* Process monsters with even more energy first */
+    for (c = chunk_list_first(); c; c = c->live_next)
+    {
+        if (level_dormant(c)) continue;
+        start = get_clock_usec();
+        process_monsters(c, true);
+        prof_add(PROF_MONSTERS, c, start);
+    }
 
     /* Check for death */
     process_death();
@@ -1993,66 +2323,45 @@ static void process_worn(struct player *p, struct object *ring)
 static void post_turn_game_loop(void)
 {
     int i;
-    struct loc grid;
+    struct chunk *c;
+    long long start;
 
     /* Check for death */
     process_death();
 
     /* Process the rest of the monsters */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+    for (c = chunk_list_first(); c; c = c->live_next)
     {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-        {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
+        if (level_dormant(c)) continue;
+        start = get_clock_usec();
+        process_monsters(c, false);
 
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
-            {
-                struct chunk *c = w_ptr->chunk_list[i];
-
-                if (c)
-                {
-                    process_monsters(c, false);
-
-                    /* Mark all monsters as ready to act when they have the energy */
-                    reset_monsters(c);
-                }
-            }
-        }
+        /* Mark all monsters as ready to act when they have the energy */
+        reset_monsters(c);
+        prof_add(PROF_MONSTERS, c, start);
     }
 
     /* Check for death */
     process_death();
 
     /* Process the objects */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+    for (c = chunk_list_first(); c; c = c->live_next)
     {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-        {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
-
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
-            {
-                struct chunk *c = w_ptr->chunk_list[i];
-
-                if (c) process_objects(c);
-            }
-        }
+        if (level_dormant(c)) continue;
+        start = get_clock_usec();
+        process_objects(c);
+        prof_add(PROF_OBJECTS, c, start);
     }
 
-    /* Process the world */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+    /* Process the world every ten turns */
+    if (!(turn.turn % 10))
     {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
+        for (c = chunk_list_first(); c; c = c->live_next)
         {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
-
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
-            {
-                struct chunk *c = w_ptr->chunk_list[i];
-
-                /* Process the world every ten turns */
-                if (c && !(turn.turn % 10)) process_world(NULL, c);
-            }
+            if (level_dormant(c)) continue;
+            start = get_clock_usec();
+            process_world(NULL, c);
+            prof_add(PROF_WORLD, c, start);
         }
     }
 
@@ -2063,11 +2372,18 @@ static void post_turn_game_loop(void)
 
         /* Process the world of that player */
         if (!p->upkeep->new_level_method && !p->upkeep->funeral)
-            process_world(p, chunk_get(&p->wpos));
+        {
+            c = chunk_get(&p->wpos);
+            start = get_clock_usec();
+            process_world(p, c);
+            prof_add(PROF_WORLD, chunk_get(&p->wpos), start);
+        }
     }
 
     /* Process everything else */
+    start = get_clock_usec();
     process_various();
+    prof_add(PROF_VARIOUS, NULL, start);
 
     /* Give energy to all players */
     for (i = 1; i <= NumPlayers; i++)
@@ -2079,19 +2395,9 @@ static void post_turn_game_loop(void)
     }
 
     /* Give energy to all monsters */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+    for (c = chunk_list_first(); c; c = c->live_next)
     {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-        {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
-
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
-            {
-                struct chunk *c = w_ptr->chunk_list[i];
-
-                if (c) energize_monsters(c);
-            }
-        }
+        if (!level_dormant(c)) energize_monsters(c);
     }
 
     /* Count game turns */
@@ -2138,6 +2444,7 @@ static void post_turn_game_loop(void)
     }
 
     /* Refresh everybody's displays */
+    start = get_clock_usec();
     for (i = 1; i <= NumPlayers; i++)
     {
         struct player *p = player_get(i);
@@ -2153,6 +2460,7 @@ static void post_turn_game_loop(void)
         /* Normal refresh (without monster/object lists) */
         p->full_refresh = false;
     }
+    prof_add(PROF_REFRESH, NULL, start);
 
     /* Process extra stuff */
     for (i = 1; i <= NumPlayers; i++)
@@ -2178,7 +2486,9 @@ static void post_turn_game_loop(void)
     }
 
     /* Send any information over the network */
+    start = get_clock_usec();
     Net_output();
+    prof_add(PROF_NET_OUTPUT, NULL, start);
 
     /* Get rid of dead players */
     for (i = NumPlayers; i > 0; i--)
@@ -2227,7 +2537,12 @@ static void post_turn_game_loop(void)
     {
         struct player *p = player_get(i);
 
-        if (p->upkeep->new_level_method) generate_new_level(p);
+        if (p->upkeep->new_level_method)
+        {
+            start = get_clock_usec();
+            generate_new_level(p);
+            prof_add(PROF_NEW_LEVEL, chunk_get(&p->wpos), start);
+        }
     }
 }
 
@@ -2320,6 +2635,7 @@ static void process_player_turn_based(struct player *p)
 void run_game_loop(void)
 {
     int i;
+    long long start = get_clock_usec();
 
     /* HIGHLY EXPERIMENTAL: turn-based mode (for single player games) */
     if (TURN_BASED && process_turn_based())
@@ -2354,6 +2670,7 @@ void run_game_loop(void)
             Net_output_p(p);
         }
 
+        prof_frame_end(start);
         return;
     }
 
@@ -2366,11 +2683,21 @@ void run_game_loop(void)
         struct player *p = player_get(i);
 
         /* Process that player */
-        if (!p->upkeep->new_level_method && !p->upkeep->funeral) process_player(p);
+        if (!p->upkeep->new_level_method && !p->upkeep->funeral)
+        {
+            long long player_start = get_clock_usec();
+
+            process_player(p);
+
+            /* The level may have been regenerated (Alter Reality...): look it up again */
+            prof_add(PROF_PLAYER, chunk_get(&p->wpos), player_start);
+        }
     }
 
     /* Execute post-turn processing */
     post_turn_game_loop();
+
+    prof_frame_end(start);
 }
 
 
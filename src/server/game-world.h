@@ -22,16 +22,49 @@
 
 #define TURN_BASED (cfg_turn_based && (NumPlayers == 1))
 
+/*
+ * Phases of the game loop timed by the frame profiler
+ */
+enum
+{
+    PROF_PLAYER = 0,
+    PROF_MONSTERS,
+    PROF_OBJECTS,
+    PROF_WORLD,
+    PROF_REFRESH,
+    PROF_NET_INPUT,
+    PROF_NET_OUTPUT,
+    PROF_NEW_LEVEL,
+    PROF_VARIOUS,
+    PROF_FRAME,
+
+    PROF_MAX
+};
+
+/*
+ * Frame profiler results for a phase (usec)
+ */
+struct prof_summary
+{
+    long samples;
+    long p50;
+    long p99;
+    long max;
+};
+
 extern bool server_generated;
 extern bool server_state_loaded;
 extern uint32_t seed_flavor;
 extern hturn turn;
+extern const char *prof_phase_names[PROF_MAX];
 
 extern bool is_daytime_turn(hturn *ht_ptr);
 extern bool is_daytime(void);
 extern void dusk_or_dawn(struct player *p, struct chunk *c, bool dawn);
 extern int turn_energy(int speed);
 extern int frame_energy(int speed);
+extern void prof_summarize(struct chunk *c, int phase, struct prof_summary *sum);
+extern void prof_reset(void);
 extern void run_game_loop(void);
 extern void kingly(struct player *p);
 extern bool level_keep_allocated(struct chunk *c);
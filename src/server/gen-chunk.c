@@ -38,6 +38,54 @@ static int chunk_index(struct wild_type *w_ptr, int depth)
 }
 
 
+/*
+ * Live levels, oldest first
+ *
+ * Every chunk in the chunk lists is also linked here, so that the game loop only visits the
+ * levels that exist instead of every depth of every wilderness grid.
+ */
+static struct chunk *live_first, *live_last;
+
+
+static bool chunk_is_live(struct chunk *c)
+{
+    return (c->live_prev || (live_first == c));
+}
+
+
+static void chunk_live_unlink(struct chunk *c)
+{
+    if (!chunk_is_live(c)) return;
+
+    if (c->live_prev) c->live_prev->live_next = c->live_next;
+    else live_first = c->live_next;
+    if (c->live_next) c->live_next->live_prev = c->live_prev;
+    else live_last = c->live_prev;
+    c->live_prev = c->live_next = NULL;
+}
+
+
+/*
+ * Put a player on the roster of a level, unless he is already on it
+ */
+static void chunk_roster_insert(struct chunk *c, struct player *p)
+{
+    int i;
+
+    for (i = 0; i < c->roster_num; i++)
+    {
+        if (c->roster[i] == p) return;
+    }
+
+    if (c->roster_num == c->roster_size)
+    {
+        c->roster_size = (c->roster_size? c->roster_size * 2: 4);
+        c->roster = mem_realloc(c->roster, c->roster_size * sizeof(struct player *));
+    }
+    c->roster[c->roster_num++] = p;
+}
+
+
 /*
  * Add an entry to the chunk list.
  *
@@ -46,8 +94,26 @@ static int chunk_index(struct wild_type *w_ptr, int depth)
 void chunk_list_add(struct chunk *c)
 {
     struct wild_type *w_ptr = get_wt_info_at(&c->wpos.grid);
+    int index = chunk_index(w_ptr, c->wpos.depth), i;
 
-    w_ptr->chunk_list[chunk_index(w_ptr, c->wpos.depth)] = c;
+    /* Players already headed there are on the level */
+    for (i = 1; i <= NumPlayers; i++)
+    {
+        struct player *p = player_get(i);
+
+        if (wpos_eq(&p->wpos, &c->wpos)) chunk_roster_insert(c, p);
+    }
+
+    /* Replace the previous level */
+    if (w_ptr->chunk_list[index] && (w_ptr->chunk_list[index] != c))
+        chunk_live_unlink(w_ptr->chunk_list[index]);
+    w_ptr->chunk_list[index] = c;
+
+    if (chunk_is_live(c)) return;
+    c->live_prev = live_last;
+    if (live_last) live_last->live_next = c;
+    else live_first = c;
+    live_last = c;
 }
 
 
@@ -61,6 +127,18 @@ void chunk_list_remove(struct chunk *c)
     struct wild_type *w_ptr = get_wt_info_at(&c->wpos.grid);
 
     w_ptr->chunk_list[chunk_index(w_ptr, c->wpos.depth)] = NULL;
+    chunk_live_unlink(c);
+}
+
+
+/*
+ * Get the first live level, the others follow through "live_next".
+ *
+ * Loops that may remove the current level should read "live_next" first.
+ */
+struct chunk *chunk_list_first(void)
+{
+    return live_first;
 }
 
 
@@ -108,6 +186,98 @@ struct chunk *chunk_get(struct worldpos *wpos)
 }
 
 
+/*
+ * Level rosters
+ *
+ * Each live level lists the players whose position is on it (the same players a scan of the
+ * whole player list with wpos_eq() would find, including those who just arrived and wait for
+ * the level to be generated), so that per-level code only looks at them. The roster is filled
+ * when the level is added to the chunk list, and updated when a player enters the game,
+ * changes level or leaves.
+ */
+
+
+/*
+ * Add a player to the roster of the level at his position, if it exists
+ */
+void chunk_roster_add(struct player *p)
+{
+    struct chunk *c = chunk_get(&p->wpos);
+
+    if (c) chunk_roster_insert(c, p);
+}
+
+
+/*
+ * Remove a player from the roster of the level at his position, if it exists
+ */
+void chunk_roster_remove(struct player *p)
+{
+    struct chunk *c = chunk_get(&p->wpos);
+    int i;
+
+    if (!c) return;
+
+    for (i = 0; i < c->roster_num; i++)
+    {
+        if (c->roster[i] != p) continue;
+
+        /* Keep the others in order */
+        c->roster_num--;
+        memmove(&c->roster[i], &c->roster[i + 1], (c->roster_num - i) * sizeof(struct player *));
+        break;
+    }
+
+    /* Monsters look for their closest player once per game turn: make them forget him now */
+    for (i = 1; i < cave_monster_max(c); i++)
+    {
+        struct monster *mon = cave_monster(c, i);
+
+        if (mon->closest_player == p) mon->closest_player = NULL;
+    }
+}
+
+
+/*
+ * Make the monsters of all levels forget a player leaving the game
+ *
+ * Controlled monsters on other levels may track their master as closest player.
+ */
+void chunk_list_forget_player(struct player *p)
+{
+    struct chunk *c;
+    int i;
+
+    for (c = chunk_list_first(); c; c = c->live_next)
+    {
+        for (i = 1; i < cave_monster_max(c); i++)
+        {
+            struct monster *mon = cave_monster(c, i);
+
+            if (mon->closest_player == p) mon->closest_player = NULL;
+        }
+    }
+}
+
+
+/*
+ * Number of players on a level
+ */
+int chunk_roster_num(struct chunk *c)
+{
+    return c->roster_num;
+}
+
+
+/*
+ * Get the i'th player on a level (from 0 to chunk_roster_num() - 1)
+ */
+struct player *chunk_roster_get(struct chunk *c, int i)
+{
+    return c->roster[i];
+}
+
+
 /*
  * Get the index of an entry in the players_on_depth array corresponding to the given depth.
  */
@@ -312,6 +312,12 @@ extern struct chunk *arena_gen(struct player *p, struct worldpos *wpos, int min_
 /* gen-chunk.c */
 extern void chunk_list_add(struct chunk *c);
 extern void chunk_list_remove(struct chunk *c);
+extern struct chunk *chunk_list_first(void);
+extern void chunk_roster_add(struct player *p);
+extern void chunk_roster_remove(struct player *p);
+extern void chunk_list_forget_player(struct player *p);
+extern int chunk_roster_num(struct chunk *c);
+extern struct player *chunk_roster_get(struct chunk *c, int i);
 extern void chunk_validate_objects(struct chunk *c);
 extern struct chunk *chunk_get(struct worldpos *wpos);
 extern bool chunk_inhibit_players(struct worldpos *wpos);
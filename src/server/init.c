@@ -43,6 +43,7 @@ char *cfg_console_password = NULL;
 char *cfg_dungeon_master = NULL;
 bool cfg_secret_dungeon_master = true;
 uint32_t cfg_max_account_chars = 12;
+int32_t cfg_slow_frame_log = 0;
 bool cfg_no_steal = true;
 bool cfg_newbies_cannot_drop = true;
 int32_t cfg_level_unstatic_chance = 60;
@@ -54,6 +55,7 @@ bool cfg_limit_player_connections = true;
 int32_t cfg_tcp_port = 18346;
 int16_t cfg_quit_timeout = 5;
 uint32_t cfg_disconnect_fainting = 180;
+int32_t cfg_compress_level = 0;
 bool cfg_chardump_color = false;
 int16_t cfg_pvp_hostility = PVP_SAFE;
 bool cfg_base_monsters = true;
@@ -4966,6 +4968,11 @@ static void set_server_option(const char *option, char *value)
         /* Hack -- reinstall the timer handler to match the new FPS */
         install_timer_tick(run_game_loop, cfg_fps);
     }
+    else if (streq(option, "SLOW_FRAME_LOG"))
+    {
+        cfg_slow_frame_log = atoi(value);
+        if (cfg_slow_frame_log < 0) cfg_slow_frame_log = 0;
+    }
     else if (streq(option, "MAX_ACCOUNT_CHARS"))
     {
         cfg_max_account_chars = atoi(value);
@@ -5008,6 +5015,14 @@ static void set_server_option(const char *option, char *value)
     }
     else if (streq(option, "DISCONNECT_FAINTING"))
         cfg_disconnect_fainting = atoi(value);
+    else if (streq(option, "COMPRESS_LEVEL"))
+    {
+        cfg_compress_level = atoi(value);
+
+        /* Sanity checks */
+        if (cfg_compress_level < 0) cfg_compress_level = 0;
+        if (cfg_compress_level > 9) cfg_compress_level = 9;
+    }
     else if (streq(option, "CHARACTER_DUMP_COLOR"))
         cfg_chardump_color = str_to_boolean(value);
     else if (streq(option, "PVP_HOSTILITY"))
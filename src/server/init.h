@@ -23,6 +23,7 @@ extern char *cfg_console_password;
 extern char *cfg_dungeon_master;
 extern bool cfg_secret_dungeon_master;
 extern uint32_t cfg_max_account_chars;
+extern int32_t cfg_slow_frame_log;
 extern bool cfg_no_steal;
 extern bool cfg_newbies_cannot_drop;
 extern int32_t cfg_level_unstatic_chance;
@@ -34,6 +35,7 @@ extern bool cfg_limit_player_connections;
 extern int32_t cfg_tcp_port;
 extern int16_t cfg_quit_timeout;
 extern uint32_t cfg_disconnect_fainting;
+extern int32_t cfg_compress_level;
 extern bool cfg_chardump_color;
 extern int16_t cfg_pvp_hostility;
 extern bool cfg_base_monsters;
@@ -696,6 +696,9 @@ static void monster_index_move(struct chunk *c, int i1, int i2)
     if (!mon) return;
     source_monster(mon1, mon);
 
+    /* The queue of monsters ready to act must be rebuilt */
+    c->ready_stale = true;
+
     /* New monster */
     newmon = cave_monster(c, i2);
     source_monster(mon2, newmon);
@@ -719,14 +722,11 @@ static void monster_index_move(struct chunk *c, int i1, int i2)
         mon->mimicked_obj->mimicking_m_idx = i2;
 
     /* Copy the visibility and los flags for the players */
-    for (i = 1; i <= NumPlayers; i++)
+    for (i = 0; i < chunk_roster_num(c); i++)
     {
-        struct player *p = player_get(i);
+        struct player *p = chunk_roster_get(c, i);
         struct source *health_who = &p->upkeep->health_who;
 
-        /* If he's not here, skip him */
-        if (!wpos_eq(&p->wpos, &c->wpos)) continue;
-
         mflag_copy(p->mflag[i2], p->mflag[i1]);
         p->mon_det[i2] = p->mon_det[i1];
 
@@ -745,6 +745,13 @@ static void monster_index_move(struct chunk *c, int i1, int i2)
         newmon->blow = mem_zalloc(z_info->mon_blows_max * sizeof(struct monster_blow));
     memcpy(newmon->blow, mon->blow, z_info->mon_blows_max * sizeof(struct monster_blow));
 
+    /* Put the new index on the list of wounded monsters */
+    if (mflag_has(newmon->mflag, MFLAG_WOUNDED))
+    {
+        mflag_off(newmon->mflag, MFLAG_WOUNDED);
+        monster_note_wounded(c, newmon);
+    }
+
     /* Wipe hole */
     mem_free(mon->blow);
     memset(mon, 0, sizeof(struct monster));
@@ -913,6 +920,10 @@ void wipe_mon_list(struct chunk *c)
     /* Reset the number of clones */
     c->num_repro = 0;
 
+    /* Forget the wounded and queued monsters */
+    c->wounded_num = 0;
+    c->ready_num = 0;
+
     for (i = 1; i <= NumPlayers; i++)
     {
         struct player *p = player_get(i);
@@ -1415,6 +1426,14 @@ int16_t place_monster(struct player *p, struct chunk *c, struct monster *mon, ui
     /* Set the ID */
     new_mon->midx = m_idx;
 
+    /* Keep track of wounded monsters and running timed effects */
+    mflag_off(new_mon->mflag, MFLAG_WOUNDED);
+    monster_note_wounded(c, new_mon);
+    mon_note_timed(new_mon);
+
+    /* Loaded monsters may be ready to act before energize_monsters() queues them */
+    if (new_mon->energy >= move_energy(new_mon->wpos.depth)) c->ready_stale = true;
+
     /* Set the location */
     square_set_mon(c, &mon->grid, new_mon->midx);
     my_assert(square_monster(c, &mon->grid) == new_mon);
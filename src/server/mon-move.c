@@ -2421,7 +2421,7 @@ static bool monster_check_active(struct chunk *c, struct monster *mon, int *targ
 /*
  * Handle fear, poison, bleeding
  */
-static void monster_effects(struct player *p, struct monster *mon)
+static void monster_effects(struct player *p, struct chunk *c, struct monster *mon)
 {
     struct source who_body;
     struct source *who = &who_body;
@@ -2452,6 +2452,7 @@ static void monster_effects(struct player *p, struct monster *mon)
             if (mon->hp > 0)
             {
                 mon->hp--;
+                monster_note_wounded(c, mon);
 
                 /* Unconscious state - message if visible */
                 if ((mon->hp == 0) && monster_is_visible(p, mon->midx))
@@ -2483,6 +2484,7 @@ static void monster_effects(struct player *p, struct monster *mon)
             if (mon->hp > 0)
             {
                 mon->hp--;
+                monster_note_wounded(c, mon);
 
                 /* Unconscious state - message if visible */
                 if ((mon->hp == 0) && monster_is_visible(p, mon->midx))
@@ -2569,7 +2571,7 @@ static void monster_reduce_sleep(struct monster *mon, bool mvm)
  *
  * Returns true if the monster is skipping its turn.
  */
-static bool process_monster_timed(struct monster *mon, bool mvm)
+static bool process_monster_timed(struct chunk *c, struct monster *mon, bool mvm)
 {
     struct player *p = mon->closest_player;
 
@@ -2583,6 +2585,9 @@ static bool process_monster_timed(struct monster *mon, bool mvm)
     /* Awake, active monsters may become aware */
     if (one_in_(10) && mflag_has(mon->mflag, MFLAG_ACTIVE)) mflag_on(mon->mflag, MFLAG_AWARE);
 
+    /* Nothing else to do without timed effects */
+    if (!mflag_has(mon->mflag, MFLAG_TIMED)) return false;
+
     if (mon->m_timed[MON_TMD_FAST])
         mon_dec_timed(p, mon, MON_TMD_FAST, 1, 0);
 
@@ -2608,7 +2613,7 @@ static bool process_monster_timed(struct monster *mon, bool mvm)
         mon_dec_timed(p, mon, MON_TMD_BLIND, 1, MON_TMD_FLG_NOTIFY);
 
     /* Handle fear, poison, bleeding */
-    monster_effects(p, mon);
+    monster_effects(p, c, mon);
 
     /* Always miss turn if held, one in STUN_MISS_CHANCE chance of missing if stunned */
     if (mon->m_timed[MON_TMD_HOLD]) return true;
@@ -2676,15 +2681,12 @@ static void get_closest_player(struct chunk *c, struct monster *mon)
     int dis_to_closest = 9999, lowhp = 9999;
     bool blos = false, new_los;
 
-    /* Check for each player */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check for each player on the level */
+    for (i = 0; i < chunk_roster_num(c); i++)
     {
-        struct player *p = player_get(i);
+        struct player *p = chunk_roster_get(c, i);
         int d;
 
-        /* Make sure he's on the same dungeon level */
-        if (!wpos_eq(&p->wpos, &mon->wpos)) continue;
-
         /* Hack -- skip him if he's shopping */
         if (in_store(p)) continue;
 
@@ -2749,12 +2751,86 @@ static void get_closest_player(struct chunk *c, struct monster *mon)
 }
 
 
+/*
+ * Regenerate the wounded monsters, every 100 "scaled" turns.
+ *
+ * Healed monsters, and stale entries left by dead or moved monsters, are removed from the list.
+ */
+static void regen_monsters(struct chunk *c)
+{
+    int i, num = 0;
+
+    for (i = 0; i < c->wounded_num; i++)
+    {
+        struct monster *mon;
+
+        /* Skip stale entries (and duplicates, since the flag is turned off below) */
+        if (c->wounded[i] >= cave_monster_max(c)) continue;
+        mon = cave_monster(c, c->wounded[i]);
+        if (!mon->race || !mflag_has(mon->mflag, MFLAG_WOUNDED)) continue;
+        mflag_off(mon->mflag, MFLAG_WOUNDED);
+
+        /* Only conscious monsters with a closest player regenerate */
+        if (mon->hp && mon->closest_player)
+        {
+            int time = move_energy(c->wpos.depth) / turn_time_factor(mon->closest_player, c);
+
+            if (!(turn.turn % time)) regen_monster(mon);
+        }
+
+        /* Keep it until fully healed */
+        if (mon->hp < mon->maxhp) c->wounded[num++] = c->wounded[i];
+    }
+
+    c->wounded_num = num;
+    for (i = 0; i < num; i++) mflag_on(cave_monster(c, c->wounded[i])->mflag, MFLAG_WOUNDED);
+}
+
+
+/*
+ * Queue a monster which has enough energy to act (see process_monsters())
+ */
+void queue_monster(struct chunk *c, struct monster *mon)
+{
+    if (c->ready_num == c->ready_size)
+    {
+        c->ready_size = (c->ready_size? c->ready_size * 2: 16);
+        c->ready = mem_realloc(c->ready, c->ready_size * sizeof(int));
+    }
+    c->ready[c->ready_num++] = mon->midx;
+}
+
+
+/*
+ * Rebuild the queue of monsters which have enough energy to act, after the monster list has
+ * changed behind energize_monsters()
+ */
+static void queue_ready_monsters(struct chunk *c)
+{
+    int i;
+
+    c->ready_num = 0;
+    c->ready_stale = false;
+
+    /* Same order as the monster list (backwards) */
+    for (i = cave_monster_max(c) - 1; i >= 1; i--)
+    {
+        struct monster *mon = cave_monster(c, i);
+
+        if (!mon->race || (mon->hp == 0)) continue;
+        if (mon->energy >= move_energy(mon->wpos.depth)) queue_monster(c, mon);
+    }
+}
+
+
 /*
  * Process all the "live" monsters, once per game turn.
  *
- * During each game turn, we scan through the list of all the "live" monsters,
- * (backwards, so we can excise any "freshly dead" monsters), allowing fully
- * energized monsters to move, attack, pass, etc.
+ * During each game turn, we go through the monsters which have gained enough energy to act
+ * (queued by energize_monsters() in the order of the monster list, backwards, so we can excise
+ * any "freshly dead" monsters), allowing them to move, attack, pass, etc. The other monsters
+ * have nothing to do: they only get their closest player once per game turn, which sets the
+ * energy they gain, and regenerate through regen_monsters().
  *
  * This function and its children are responsible for a considerable fraction
  * of the processor time in normal situations, greater if the character is
@@ -2762,13 +2838,13 @@ static void get_closest_player(struct chunk *c, struct monster *mon)
  */
 void process_monsters(struct chunk *c, bool more_energy)
 {
-    int i, j, time;
+    int i, j, k;
 
-    /* Only process some things every so often */
-    bool regen;
+    /* The monster list has changed since the queue was built */
+    if (c->ready_stale) queue_ready_monsters(c);
 
-    /* Process the monsters (backwards) */
-    for (i = cave_monster_max(c) - 1; i >= 1; i--)
+    /* Process the monsters which have enough energy to act */
+    for (k = 0; k < c->ready_num; k++)
     {
         struct monster *mon;
         int target_m_dis;
@@ -2777,6 +2853,8 @@ void process_monsters(struct chunk *c, bool more_energy)
         struct source *who = &who_body;
 
         /* Get a 'live' monster */
+        i = c->ready[k];
+        if (i >= cave_monster_max(c)) continue;
         mon = cave_monster(c, i);
         if (!mon->race) continue;
 
@@ -2798,14 +2876,6 @@ void process_monsters(struct chunk *c, bool more_energy)
         /* Prevent reprocessing */
         mflag_on(mon->mflag, MFLAG_HANDLED);
 
-        /* Regenerate hitpoints and mana every 100 "scaled" turns */
-        regen = false;
-        time = move_energy(c->wpos.depth) / time_factor(mon->closest_player, c);
-        if (!(turn.turn % time)) regen = true;
-
-        /* Handle monster regeneration if requested */
-        if (regen) regen_monster(mon);
-
         /* End the turn of monsters without enough energy to move */
         if (mon->energy < move_energy(mon->wpos.depth)) continue;
 
@@ -2833,7 +2903,7 @@ void process_monsters(struct chunk *c, bool more_energy)
         if (monster_check_active(c, mon, &target_m_dis, &mvm, who))
         {
             /* Process timed effects - skip turn if necessary */
-            if (process_monster_timed(mon, mvm)) continue;
+            if (process_monster_timed(c, mon, mvm)) continue;
 
             /* The monster takes its turn */
             monster_turn(who, c, mon, target_m_dis);
@@ -2843,6 +2913,21 @@ void process_monsters(struct chunk *c, bool more_energy)
         }
     }
 
+    if (!more_energy)
+    {
+        /* Get closest player of the other monsters, their energy depends on it */
+        for (i = cave_monster_max(c) - 1; i >= 1; i--)
+        {
+            struct monster *mon = cave_monster(c, i);
+
+            if (!mon->race || (mon->hp == 0) || mflag_has(mon->mflag, MFLAG_HANDLED)) continue;
+            get_closest_player(c, mon);
+        }
+
+        /* Handle monster regeneration once all the monsters have been processed this turn */
+        regen_monsters(c);
+    }
+
     /* Efficiency */
     if (!c->scan_monsters) return;
 
@@ -9,6 +9,7 @@
 extern bool race_hates_grid(struct chunk *c, struct monster_race *race, struct loc *grid);
 extern bool monster_hates_grid(struct chunk *c, struct monster *mon, struct loc *grid);
 extern bool multiply_monster(struct player *p, struct chunk *c, struct monster *mon);
+extern void queue_monster(struct chunk *c, struct monster *mon);
 extern void process_monsters(struct chunk *c, bool more_energy);
 extern void reset_monsters(struct chunk *c);
 extern bool is_closest(struct player *p, struct chunk *c, struct monster *mon, bool blos,
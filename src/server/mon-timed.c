@@ -218,6 +218,9 @@ static bool mon_set_timed(struct player *p, struct monster *mon, int effect_type
         }
     }
 
+    /* Keep track of the running effects */
+    if (update) mon_note_timed(mon);
+
     /*
      * Print a message if there is one, if the effect allows for it, and if
      * the monster is visible
@@ -352,6 +355,27 @@ bool mon_clear_timed(struct player *p, struct monster *mon, int effect_type, int
 }
 
 
+/*
+ * Note whether a monster has any timed effect running, so that monsters without any can skip
+ * the timed effect processing on their turn.
+ */
+void mon_note_timed(struct monster *mon)
+{
+    int i;
+
+    for (i = 0; i < MON_TMD_MAX; i++)
+    {
+        if (mon->m_timed[i])
+        {
+            mflag_on(mon->mflag, MFLAG_TIMED);
+            return;
+        }
+    }
+
+    mflag_off(mon->mflag, MFLAG_TIMED);
+}
+
+
 /*
  * The level at which an effect is affecting a monster.
  * Levels range from 0 (unaffected) to 5 (maximum effect).
@@ -494,13 +494,12 @@ void update_mon(struct monster *mon, struct chunk *c, bool full)
     my_assert(mon != NULL);
     source_monster(who, mon);
 
-    /* Check for each player */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check for each player on the level */
+    for (i = 0; i < chunk_roster_num(c); i++)
     {
-        struct player *p = player_get(i);
+        struct player *p = chunk_roster_get(c, i);
 
         /* Skip irrelevant players */
-        if (!wpos_eq(&p->wpos, &mon->wpos)) continue;
         if (p->upkeep->new_level_method || p->upkeep->funeral) continue;
         if (!p->placed) continue;
 
@@ -1309,6 +1308,25 @@ static void monster_scared_by_damage(struct player *p, struct chunk *c, struct m
 }
 
 
+/*
+ * Put a monster below its max HP on the list of wounded monsters of the level, so that
+ * regeneration only looks at them. Monsters leave the list once healed (see regen_monsters()).
+ */
+void monster_note_wounded(struct chunk *c, struct monster *mon)
+{
+    if (mon->hp >= mon->maxhp) return;
+    if (mflag_has(mon->mflag, MFLAG_WOUNDED)) return;
+
+    if (c->wounded_num == c->wounded_size)
+    {
+        c->wounded_size = (c->wounded_size? c->wounded_size * 2: 16);
+        c->wounded = mem_realloc(c->wounded, c->wounded_size * sizeof(int));
+    }
+    c->wounded[c->wounded_num++] = mon->midx;
+    mflag_on(mon->mflag, MFLAG_WOUNDED);
+}
+
+
 /*
  * Decreases a monster's hit points by `dam` and handle monster death.
  *
@@ -1351,6 +1369,7 @@ bool mon_take_hit(struct player *p, struct chunk *c, struct monster *mon, int da
     /* Hurt it */
     mon->hp -= dam;
     mflag_on(p->mflag[mon->midx], MFLAG_HURT);
+    monster_note_wounded(c, mon);
 
     /* Hack -- icy aura knocks unconscious instead of killing */
     if (p->icy_aura && (mon->hp < 0)) mon->hp = 0;
@@ -36,6 +36,7 @@ extern void update_smart_learn(struct monster *mon, struct player *p, int flag,
 extern bool find_any_nearby_injured_kin(struct chunk *c, const struct monster *mon);
 extern struct monster *choose_nearby_injured_kin(struct chunk *c, const struct monster *mon);
 extern void monster_death(struct player *p, struct chunk *c, struct monster *mon);
+extern void monster_note_wounded(struct chunk *c, struct monster *mon);
 extern bool mon_take_hit(struct player *p, struct chunk *c, struct monster *mon, int dam,
     bool *fear, int note);
 extern void monster_take_terrain_damage(struct chunk *c, struct monster *mon);
@@ -21,12 +21,15 @@
 
 
 #define MAX_RELIABLE_DATA_PACKET_SIZE   512
-#define MAX_TEXTFILE_CHUNK              512
+#define MAX_TEXTFILE_CHUNK              (TEXTFILE__WID * TEXTFILE__HGT)
+#define MAP_FRAME_SIZE                  (8*1024)
+#define STATUS_WATERMARK                (SERVER_SEND_SIZE / 4)
 
 
 static server_setup_t Setup;
 static int login_in_progress;
 static int num_logins, num_logouts;
+static struct conn_traffic traffic_gone;
 
 
 /* The contact socket */
@@ -34,6 +37,16 @@ static int Socket;
 static sockbuf_t ibuf;
 
 
+/* Encoded struct info sent at login, and its digest for clients that cache it */
+static char struct_info_hash[33];
+static void free_struct_info(void);
+static int build_struct_info(void);
+
+
+/* A map row encoded once for all the connections that display it */
+static sockbuf_t frame;
+
+
 /*** Player connection/index wrappers ***/
 
 
@@ -55,6 +68,9 @@ static void init_connections(void)
     Conn = mem_alloc(size);
     if (!Conn) quit("Cannot allocate memory for connections");
     memset(Conn, 0, size);
+
+    if (Sockbuf_init(&frame, -1, MAP_FRAME_SIZE, SOCKBUF_WRITE | SOCKBUF_LOCK) == -1)
+        quit("Cannot allocate memory for map frames");
 }
 
 
@@ -62,6 +78,7 @@ static void free_connections(void)
 {
     mem_free(Conn);
     Conn = NULL;
+    Sockbuf_cleanup(&frame);
 }
 
 
@@ -104,10 +121,16 @@ int Setup_net_server(void)
 {
     if (Init_setup() == -1) return -1;
 
+    /* Encode the struct info sent at login */
+    if (build_struct_info() == -1) return -1;
+
     init_connections();
 
     init_players();
 
+    /* Resolve client hostnames in the background */
+    if (SLResolverInit() == -1) plog("Client hostnames will not be resolved");
+
     /* Tell the metaserver that we're starting up */
     plog("Report to metaserver");
     Report_to_meta(META_START);
@@ -191,10 +214,66 @@ static void do_quit(int ind)
 }
 
 
+/*
+ * Count the packet written to the reliable buffer since the last mark, and mark the start of
+ * the next one
+ *
+ * Must be called before each packet is written, otherwise consecutive packets are counted as
+ * one of the type of the first.
+ */
+static void traffic_mark(connection_t *connp)
+{
+    struct conn_traffic *traffic = &connp->traffic;
+    int type;
+
+    /* The packet was taken back */
+    if (connp->c.len <= traffic->mark)
+    {
+        traffic->mark = connp->c.len;
+        return;
+    }
+
+    type = (connp->c.buf[traffic->mark] & 0xFF);
+    if (type >= PKT_MAX) type = PKT_UNDEFINED;
+    traffic->pkts_out[type]++;
+    traffic->bytes_out[type] += connp->c.len - traffic->mark;
+    traffic->mark = connp->c.len;
+    if (connp->c.len > traffic->max_c) traffic->max_c = connp->c.len;
+}
+
+
+/*
+ * Add the counters of a connection to a total
+ */
+static void traffic_add(struct conn_traffic *total, const struct conn_traffic *traffic)
+{
+    int i;
+
+    for (i = 0; i < PKT_MAX; i++)
+    {
+        total->pkts_in[i] += traffic->pkts_in[i];
+        total->bytes_in[i] += traffic->bytes_in[i];
+        total->pkts_out[i] += traffic->pkts_out[i];
+        total->bytes_out[i] += traffic->bytes_out[i];
+    }
+    total->stalls += traffic->stalls;
+    total->max_c = MAX(total->max_c, traffic->max_c);
+    total->max_q = MAX(total->max_q, traffic->max_q);
+    total->max_w = MAX(total->max_w, traffic->max_w);
+    total->replies += traffic->replies;
+    total->latency += traffic->latency;
+    total->max_latency = MAX(total->max_latency, traffic->max_latency);
+    total->wire_in += traffic->wire_in;
+    total->wire_out += traffic->wire_out;
+    total->blocked += traffic->blocked;
+}
+
+
 static int Send_reliable(int ind)
 {
     connection_t *connp = get_connection(ind);
-    int num_written;
+    struct conn_traffic *traffic = &connp->traffic;
+    int num_written, pending;
 
     /*
      * Hack -- make sure we have a valid socket to write to.
@@ -202,19 +281,35 @@ static int Send_reliable(int ind)
      */
     if (connp->w.sock == -1) return 0;
 
-    if ((num_written = Sockbuf_write(&connp->w, connp->c.buf, connp->c.len)) != connp->c.len)
+    traffic_mark(connp);
+
+    /* Send the reliable data straight from its buffer, only queue what the socket won't take */
+    if ((num_written = Sockbuf_send(&connp->w, connp->c.buf, connp->c.len)) < 0)
     {
-        plog_fmt("Cannot write reliable data (%d, %d)", num_written, connp->c.len);
-        Destroy_connection(ind, "Cannot write reliable data");
+        plog_fmt("Cannot send reliable data (%d, %d)", num_written, connp->c.len);
+        Destroy_connection(ind, "Cannot send reliable data");
         return -1;
     }
-    if ((num_written = Sockbuf_flush(&connp->w)) < 0)
+
+    /* Measure the response time to the oldest command */
+    if (traffic->pending && (connp->c.len > 0))
     {
-        plog_fmt("Cannot flush reliable data (%d)", num_written);
-        Destroy_connection(ind, "Cannot flush reliable data");
-        return -1;
+        long latency = (long)(get_clock_usec() - traffic->pending);
+
+        traffic->replies++;
+        traffic->latency += latency;
+        if (latency > traffic->max_latency) traffic->max_latency = latency;
+        traffic->pending = 0;
     }
+
     Sockbuf_clear(&connp->c);
+    traffic->mark = 0;
+
+    /* The client isn't keeping up */
+    pending = Sockbuf_pending(&connp->w);
+    if (pending > 0) traffic->stalls++;
+    if (pending > traffic->max_w) traffic->max_w = pending;
+
     return num_written;
 }
 
@@ -260,6 +355,9 @@ static void Handle_input(int fd, int arg)
         return;
     }
 
+    /* Time the response from here */
+    if (!connp->traffic.pending) connp->traffic.pending = get_clock_usec();
+
     /* Add this new data to the command queue */
     if (Sockbuf_write(&connp->q, connp->r.ptr, connp->r.len) != connp->r.len)
     {
@@ -267,6 +365,7 @@ static void Handle_input(int fd, int arg)
         Destroy_connection(ind, "Can't copy queued data to buffer");
         return;
     }
+    if (connp->q.len > connp->traffic.max_q) connp->traffic.max_q = connp->q.len;
 
     /* Execute any new commands immediately if possible */
     process_pending_commands(ind);
@@ -294,6 +393,7 @@ static void Handle_input(int fd, int arg)
      */
     if (connp->c.len > 0)
     {
+        traffic_mark(connp);
         if (Packet_printf(&connp->c, "%b", (unsigned)PKT_END) <= 0)
         {
             Destroy_connection(ind, "Net input write error");
@@ -330,6 +430,9 @@ static int Setup_connection(uint32_t account, char *real, char *nick, char *addr
     int i, free_conn_index = MAX_PLAYERS, sock;
     connection_t *connp;
     bool memory_error = false;
+#ifndef WINDOWS
+    struct in_addr in;
+#endif
 
     for (i = 0; i < MAX_PLAYERS; i++)
     {
@@ -372,7 +475,9 @@ static int Setup_connection(uint32_t account, char *real, char *nick, char *addr
     if (SetSocketSendBufferSize(sock, SERVER_SEND_SIZE + 256) == -1)
         plog_fmt("Cannot set send buffer size to %d", SERVER_SEND_SIZE + 256);
 
-    Sockbuf_init(&connp->w, sock, SERVER_SEND_SIZE, SOCKBUF_WRITE);
+    /* Console connections build their replies directly in the write buffer */
+    Sockbuf_init(&connp->w, sock, SERVER_SEND_SIZE,
+        SOCKBUF_WRITE | ((conntype == CONNTYPE_PLAYER)? SOCKBUF_RING: 0));
     Sockbuf_init(&connp->r, sock, SERVER_RECV_SIZE, SOCKBUF_WRITE | SOCKBUF_READ);
     Sockbuf_init(&connp->c, -1, SERVER_SEND_SIZE, SOCKBUF_WRITE | SOCKBUF_READ | SOCKBUF_LOCK);
     Sockbuf_init(&connp->q, -1, SERVER_RECV_SIZE, SOCKBUF_WRITE | SOCKBUF_READ | SOCKBUF_LOCK);
@@ -380,6 +485,16 @@ static int Setup_connection(uint32_t account, char *real, char *nick, char *addr
     connp->id = -1;
     connp->conntype = conntype;
     connp->addr = string_make(addr);
+    connp->watching = connp->next_watcher = connp->watchers = -1;
+
+    /* Start looking up the hostname, it is usually ready by the time it is shown */
+#ifdef WINDOWS
+    /* There is no helper: the lookup would block, so leave it to whois */
+    my_strcpy(connp->resolved, addr, sizeof(connp->resolved));
+#else
+    in.s_addr = inet_addr(addr);
+    SLLookupName(in, connp->resolved, sizeof(connp->resolved));
+#endif
 
     if ((connp->w.buf == NULL) || (connp->r.buf == NULL) || (connp->c.buf == NULL) ||
         (connp->q.buf == NULL) || (connp->addr == NULL))
@@ -561,6 +676,8 @@ static void Contact(int fd, int arg)
     char status = SUCCESS, beta;
     char real_name[NORMAL_WID], nick_name[NORMAL_WID], host_name[NORMAL_WID], pass_word[NORMAL_WID];
     uint32_t account = 0L;
+    uint32_t caps = 0L;
+    bool has_caps = false;
     int *id_list = NULL;
     uint16_t num = 0, max = 0;
     size_t i, j;
@@ -688,6 +805,15 @@ static void Contact(int fd, int arg)
         nick_name[sizeof(nick_name) - 1] = '\0';
         pass_word[sizeof(pass_word) - 1] = '\0';
 
+        /* Newer clients also tell us what they support */
+        if (ibuf.len - (ibuf.ptr - ibuf.buf) >= 4)
+        {
+            Packet_scanf(&ibuf, "%lu", &caps);
+            caps &= CAPS_SUPPORTED;
+            if (!cfg_compress_level) caps &= ~CAPS_COMPRESS;
+            has_caps = true;
+        }
+
         /* Check if his names are valid */
         if (Check_names(nick_name, real_name, host_name))
             status = E_INVAL;
@@ -715,6 +841,17 @@ static void Contact(int fd, int arg)
         if (ret == -2)
             status = E_GAME_FULL;
 
+        /* Remember what we agreed on */
+        if (!status)
+        {
+            connection_t *connp = get_connection(ret);
+
+            /* Everything after the reply goes through the compressor */
+            if ((caps & CAPS_COMPRESS) && (Sockbuf_compress(&connp->w, cfg_compress_level) == -1))
+                caps &= ~CAPS_COMPRESS;
+            connp->caps = caps;
+        }
+
         /* Log the players connection */
         if (ret != -1)
         {
@@ -781,6 +918,10 @@ static void Contact(int fd, int arg)
             Packet_printf(&ibuf, "%s", name_sections[i][j]);
     }
 
+    /* Tell newer clients what we support */
+    if (has_caps) Packet_printf(&ibuf, "%lu", caps);
+    if (caps & CAPS_STRUCT_CACHE) Packet_printf(&ibuf, "%s", struct_info_hash);
+
     Net_Send(fd);
 
     /* Free the memory in the list */
@@ -933,6 +1074,10 @@ static void Delete_player(int id)
 
     set_player_index(get_connection(player_get(NumPlayers)->conn), NumPlayers);
 
+    /* Leave the level, and make sure no monster still tracks him */
+    chunk_roster_remove(p);
+    chunk_list_forget_player(p);
+
     /* Free memory */
     cleanup_player(player_get(NumPlayers));
     mem_free(player_get(NumPlayers));
@@ -953,6 +1098,296 @@ static void Delete_player(int id)
 }
 
 
+/*
+ * Line shadows: copy of the map rows as the client last received them, for clients
+ * supporting delta updates
+ */
+#define SHADOW_ROWS (z_info->dungeon_hgt + ROW_MAP + 1)
+#define SHADOW_COLS (z_info->dungeon_wid + COL_MAP)
+
+
+/*
+ * Forget the rows known by the client, so that they are sent in full again
+ */
+static void line_shadow_reset(connection_t *connp)
+{
+    if (connp->shadow.cols) memset(connp->shadow.cols, 0, SHADOW_ROWS * sizeof(int16_t));
+}
+
+
+static void line_shadow_free(connection_t *connp)
+{
+    mem_free(connp->shadow.scr);
+    mem_free(connp->shadow.trn);
+    mem_free(connp->shadow.cols);
+    memset(&connp->shadow, 0, sizeof(connp->shadow));
+}
+
+
+/*
+ * Forget the status packets known by the client, so that they are sent again
+ */
+static void status_shadow_reset(connection_t *connp)
+{
+    memset(connp->status.len, 0, sizeof(connp->status.len));
+    memset(connp->status.pending, 0, sizeof(connp->status.pending));
+    connp->status.any_pending = false;
+}
+
+
+static void status_shadow_free(connection_t *connp)
+{
+    int i;
+
+    for (i = 0; i < STATUS_MAX; i++) mem_free(connp->status.data[i]);
+    memset(&connp->status, 0, sizeof(connp->status));
+}
+
+
+/*
+ * Check if the client is too far behind to be sent status packets right away
+ */
+static bool status_shadow_lagging(connection_t *connp)
+{
+    return (Sockbuf_pending(&connp->w) > STATUS_WATERMARK);
+}
+
+
+/*
+ * Drop a status packet just written at "start" in the reliable buffer if the client
+ * already has the same one, otherwise remember it
+ *
+ * If the client lags behind, the packet is held back until the connection drains.
+ *
+ * Returns "ret", the result of writing the packet.
+ */
+static int status_shadow_check(connection_t *connp, int slot, int start, int ret)
+{
+    struct status_shadow *status = &connp->status;
+    char *data = connp->c.buf + start;
+    int len = connp->c.len - start;
+
+    if ((ret <= 0) || (len <= 0)) return ret;
+
+    if ((status->len[slot] == len) && !memcmp(status->data[slot], data, len))
+    {
+        connp->c.len = start;
+        status->suppressed++;
+        return ret;
+    }
+
+    if (status->len[slot] != len)
+    {
+        mem_free(status->data[slot]);
+        status->data[slot] = mem_alloc(len);
+        status->len[slot] = len;
+    }
+    memcpy(status->data[slot], data, len);
+
+    /* Latest wins */
+    if (status_shadow_lagging(connp))
+    {
+        connp->c.len = start;
+        if (status->pending[slot]) status->suppressed++;
+        status->pending[slot] = status->any_pending = true;
+        status->deferred++;
+    }
+
+    return ret;
+}
+
+
+/*
+ * Send the status packets held back once the client has caught up
+ */
+static void status_shadow_flush(connection_t *connp)
+{
+    struct status_shadow *status = &connp->status;
+    int i;
+
+    if (!status->any_pending || status_shadow_lagging(connp)) return;
+
+    for (i = 0; i < STATUS_MAX; i++)
+    {
+        if (!status->pending[i]) continue;
+        traffic_mark(connp);
+        if (Sockbuf_write(&connp->c, status->data[i], status->len[i]) != status->len[i]) return;
+        status->pending[i] = false;
+    }
+    status->any_pending = false;
+}
+
+
+/*
+ * Check if the client keeps a copy of the rows of the main map that we can update
+ */
+static bool line_shadow_usable(connection_t *connp, struct player *p)
+{
+    struct line_shadow *shadow = &connp->shadow;
+
+    if (!(connp->caps & CAPS_LINE_DELTA)) return false;
+
+    /* Rows sent to another terminal don't go to the map */
+    if (p->remote_term != NTERM_WIN_OVERHEAD) return false;
+
+    /* Allocate the rows the first time */
+    if (!shadow->cols)
+    {
+        shadow->scr = mem_zalloc(SHADOW_ROWS * SHADOW_COLS * sizeof(cave_view_type));
+        shadow->trn = mem_zalloc(SHADOW_ROWS * SHADOW_COLS * sizeof(cave_view_type));
+        shadow->cols = mem_zalloc(SHADOW_ROWS * sizeof(int16_t));
+        shadow->graphics = p->use_graphics;
+    }
+
+    /* Switching graphics changes what the rows contain */
+    if (shadow->graphics != (bool)p->use_graphics)
+    {
+        line_shadow_reset(connp);
+        shadow->graphics = p->use_graphics;
+    }
+
+    return true;
+}
+
+
+/*
+ * Remember a row that was sent in full
+ */
+static void line_shadow_store(connection_t *connp, struct player *p, int y, int cols)
+{
+    struct line_shadow *shadow = &connp->shadow;
+
+    if (!line_shadow_usable(connp, p)) return;
+    if ((y >= SHADOW_ROWS) || (cols > SHADOW_COLS)) return;
+
+    memcpy(&shadow->scr[y * SHADOW_COLS], p->scr_info[y], cols * sizeof(cave_view_type));
+    memcpy(&shadow->trn[y * SHADOW_COLS], p->trn_info[y], cols * sizeof(cave_view_type));
+    shadow->cols[y] = cols;
+}
+
+
+/*
+ * Remember a single grid sent with PKT_CHAR
+ */
+static void line_shadow_grid(connection_t *connp, struct player *p, struct loc *grid,
+    uint16_t a, char c, uint16_t ta, char tc)
+{
+    struct line_shadow *shadow = &connp->shadow;
+    int i = grid->y * SHADOW_COLS + grid->x;
+
+    if (!shadow->cols || !line_shadow_usable(connp, p)) return;
+    if ((grid->y >= SHADOW_ROWS) || (grid->x >= shadow->cols[grid->y])) return;
+
+    shadow->scr[i].a = a;
+    shadow->scr[i].c = c;
+    if (p->use_graphics)
+    {
+        shadow->trn[i].a = ta;
+        shadow->trn[i].c = tc;
+    }
+}
+
+
+/*
+ * Check if a grid of a row differs from the client copy
+ */
+static bool line_grid_changed(struct line_shadow *shadow, struct player *p, int y, int x)
+{
+    cave_view_type *scr = &shadow->scr[y * SHADOW_COLS + x];
+    cave_view_type *trn = &shadow->trn[y * SHADOW_COLS + x];
+
+    if ((scr->a != p->scr_info[y][x].a) || (scr->c != p->scr_info[y][x].c)) return true;
+    if (!shadow->graphics) return false;
+    return ((trn->a != p->trn_info[y][x].a) || (trn->c != p->trn_info[y][x].c));
+}
+
+
+/*
+ * Send the grids of a row flagged in "mask" as spans of adjacent grids
+ *
+ * Returns false if the packet doesn't fit.
+ */
+static bool line_spans(connection_t *connp, struct player *p, int y, const bitflag *mask,
+    size_t size, int cols)
+{
+    struct line_shadow *shadow = &connp->shadow;
+    int x, x1, i, grids = 0, spans = 0;
+    bool known = (shadow->cols && (y < SHADOW_ROWS));
+
+    /* Count the flagged grids */
+    for (x = 0; x < cols; x++)
+    {
+        if (!flag_has(mask, size, x + FLAG_START)) continue;
+        if (!x || !flag_has(mask, size, x - 1 + FLAG_START)) spans++;
+        grids++;
+    }
+    if (!grids) return true;
+
+    /* Check that the whole packet fits */
+    if (connp->c.len + 4 + spans * 2 + grids * (p->use_graphics? 6: 3) >= connp->c.size)
+        return false;
+
+    traffic_mark(connp);
+    Packet_write_line_delta(&connp->c, y, spans);
+
+    for (x = 0; x < cols; x = x1)
+    {
+        /* Find the next span */
+        for (; (x < cols) && !flag_has(mask, size, x + FLAG_START); x++) ;
+        if (x == cols) break;
+        for (x1 = x + 1; (x1 < cols) && flag_has(mask, size, x1 + FLAG_START); x1++) ;
+
+        /* Update the client copy */
+        if (known && (x1 <= shadow->cols[y]))
+        {
+            memcpy(&shadow->scr[y * SHADOW_COLS + x], &p->scr_info[y][x],
+                (x1 - x) * sizeof(cave_view_type));
+            memcpy(&shadow->trn[y * SHADOW_COLS + x], &p->trn_info[y][x],
+                (x1 - x) * sizeof(cave_view_type));
+        }
+
+        /* Output the span: position, transparency attr/char stream, attr/char stream */
+        Packet_write_grid_span(&connp->c, (unsigned)x, (unsigned)(x1 - x));
+        for (i = x; p->use_graphics && (i < x1); i++)
+            Packet_write_grid(&connp->c, (int)p->trn_info[y][i].c, (unsigned)p->trn_info[y][i].a);
+        for (i = x; i < x1; i++)
+            Packet_write_grid(&connp->c, (int)p->scr_info[y][i].c, (unsigned)p->scr_info[y][i].a);
+    }
+
+    return true;
+}
+
+
+/*
+ * Send the spans of grids of a row that changed since the client last received it
+ *
+ * Returns false if the row must be sent in full instead.
+ */
+static bool line_delta(connection_t *connp, struct player *p, int y, int cols)
+{
+    struct line_shadow *shadow = &connp->shadow;
+    bitflag mask[FLAG_SIZE(256)];
+    int x, changed = 0;
+
+    if (!line_shadow_usable(connp, p)) return false;
+    if ((y >= SHADOW_ROWS) || (cols > 255) || (shadow->cols[y] != cols)) return false;
+
+    /* Flag the changed grids */
+    flag_wipe(mask, sizeof(mask));
+    for (x = 0; x < cols; x++)
+    {
+        if (!line_grid_changed(shadow, p, y, x)) continue;
+        flag_on(mask, sizeof(mask), x + FLAG_START);
+        changed++;
+    }
+
+    /* The whole row compresses better */
+    if (changed * 2 > cols) return false;
+
+    return line_spans(connp, p, y, mask, sizeof(mask), cols);
+}
+
+
 /*
  * Hack -- reset all connection values
  *  but keep visual verify tables
@@ -1016,6 +1451,50 @@ static void wipe_connection(connection_t *connp)
 }
 
 
+/*
+ * Spectators
+ *
+ * A console connection can watch the map of a player. The spectators of a player are
+ * chained through "next_watcher", starting from the "watchers" field of the player's
+ * connection.
+ */
+static void unwatch(int ind)
+{
+    connection_t *connp = get_connection(ind);
+    int *link;
+
+    if (connp->watching == -1) return;
+
+    for (link = &get_connection(connp->watching)->watchers; *link != -1;
+        link = &get_connection(*link)->next_watcher)
+    {
+        if (*link == ind)
+        {
+            *link = connp->next_watcher;
+            break;
+        }
+    }
+
+    connp->watching = connp->next_watcher = -1;
+}
+
+
+static void unwatch_all(connection_t *connp, const char *reason)
+{
+    char terminator = '\n';
+
+    while (connp->watchers != -1)
+    {
+        connection_t *spectator = get_connection(connp->watchers);
+
+        unwatch(connp->watchers);
+        Packet_printf(&spectator->w, "%s%c", format("\033[2J\033[HStopped watching: %s",
+            reason), (int)terminator);
+        Sockbuf_flush(&spectator->w);
+    }
+}
+
+
 /*
  * Cleanup a connection.  The client may not know yet that it is thrown out of
  * the game so we send it a quit packet if our connection to it has not already
@@ -1025,6 +1504,7 @@ static void wipe_connection(connection_t *connp)
 void Destroy_connection(int ind, char *reason)
 {
     connection_t *connp = get_connection(ind);
+    struct conn_traffic traffic;
 
     if (connp->state == CONN_FREE)
     {
@@ -1033,6 +1513,10 @@ void Destroy_connection(int ind, char *reason)
         return;
     }
 
+    /* Stop watching, and send our spectators away */
+    unwatch(ind);
+    unwatch_all(connp, reason);
+
     if (connp->conntype == CONNTYPE_PLAYER)
     {
         if (connp->w.sock != -1)
@@ -1046,7 +1530,13 @@ void Destroy_connection(int ind, char *reason)
             pkt[len - 1] = PKT_END;
             pkt[len] = '\0';
 
-            if (DgramWrite(connp->w.sock, pkt, len) != len)
+            /* A compressed stream can't take raw bytes */
+            if (connp->caps & CAPS_COMPRESS)
+            {
+                if (Sockbuf_write(&connp->w, pkt, len) == len)
+                    Sockbuf_flush(&connp->w);
+            }
+            else if (DgramWrite(connp->w.sock, pkt, len) != len)
             {
                 GetSocketError(connp->w.sock);
                 DgramWrite(connp->w.sock, pkt, len);
@@ -1054,6 +1544,13 @@ void Destroy_connection(int ind, char *reason)
         }
         plog_fmt("Goodbye %s=%s@%s (\"%s\")", (connp->nick? connp->nick: ""),
             (connp->real? connp->real: ""), (connp->host? connp->host: ""), reason);
+        if (connp->w.zraw)
+        {
+            plog_fmt("Compressed %ld bytes into %ld (%ld%%)", connp->w.zraw, connp->w.zwire,
+                connp->w.zwire * 100 / connp->w.zraw);
+        }
+        Conn_get_traffic(ind, &traffic);
+        traffic_add(&traffic_gone, &traffic);
     }
 
     Conn_set_state(connp, CONN_FREE, FREE_TIMEOUT);
@@ -1069,6 +1566,8 @@ void Destroy_connection(int ind, char *reason)
     Sockbuf_cleanup(&connp->r);
     Sockbuf_cleanup(&connp->c);
     Sockbuf_cleanup(&connp->q);
+    line_shadow_free(connp);
+    status_shadow_free(connp);
 
     if (connp->w.sock != -1)
     {
@@ -1107,8 +1606,15 @@ void Stop_net_server(void)
             mem_free(connp->Client_setup.flvr_x_char);
             mem_free(connp->Client_setup.note_aware);
         }
+        if (connp)
+        {
+            line_shadow_free(connp);
+            status_shadow_free(connp);
+        }
     }
 
+    free_struct_info();
+
     /* Dealloc player array */
     free_players();
 
@@ -1116,6 +1622,9 @@ void Stop_net_server(void)
     if (Socket != -2) remove_input(Socket);
     Sockbuf_cleanup(&ibuf);
 
+    /* Stop the name resolver */
+    SLResolverClose();
+
     /* Destroy networking */
 #ifdef WINDOWS
     free_input();
@@ -1334,6 +1843,40 @@ uint8_t *Conn_get_console_channels(int ind)
 }
 
 
+/*
+ * Get the traffic counters of a connection, including those kept by its socket buffers
+ */
+void Conn_get_traffic(int ind, struct conn_traffic *traffic)
+{
+    connection_t *connp = get_connection(ind);
+
+    memcpy(traffic, &connp->traffic, sizeof(*traffic));
+    traffic->wire_in = connp->r.nread;
+    traffic->wire_out = connp->w.nsent;
+    traffic->blocked = connp->r.nblock + connp->w.nblock;
+}
+
+
+/*
+ * Get the traffic counters of all players since the server started
+ */
+void Conn_get_traffic_total(struct conn_traffic *total)
+{
+    struct conn_traffic traffic;
+    int i;
+
+    memcpy(total, &traffic_gone, sizeof(*total));
+    for (i = 0; i < MAX_PLAYERS; i++)
+    {
+        connection_t *connp = get_connection(i);
+
+        if ((connp->state == CONN_FREE) || (connp->conntype != CONNTYPE_PLAYER)) continue;
+        Conn_get_traffic(i, &traffic);
+        traffic_add(total, &traffic);
+    }
+}
+
+
 /*** Sending ***/
 
 
@@ -1348,41 +1891,33 @@ int Send_basic_info(int ind)
         return 0;
     }
 
+    traffic_mark(connp);
+
     return Packet_printf(&connp->c, "%b%hd%b%b%b%b", (unsigned)PKT_BASIC_INFO,
         (int)Setup.frames_per_second, (unsigned)Setup.min_col, (unsigned)Setup.min_row,
         (unsigned)Setup.max_col, (unsigned)Setup.max_row);
 }
 
 
-int Send_limits_struct_info(int ind)
+static int write_limits_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint16_t dummy = 0;
     uint16_t flavor_max = get_flavor_max();
     uint16_t preset_max = player_cmax() * player_rmax();
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for limits info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_LIMITS,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_LIMITS,
         (unsigned)dummy) <= 0)
     {
-        Destroy_connection(ind, "Send_limits_struct_info write error");
         return -1;
     }
 
-    if (Packet_printf(&connp->c, "%hu%hu%hu%hu%hu%hu%hu%hu%hu%hu%hu%hu%hu", (unsigned)z_info->a_max,
+    if (Packet_printf(sbuf, "%hu%hu%hu%hu%hu%hu%hu%hu%hu%hu%hu%hu%hu", (unsigned)z_info->a_max,
         (unsigned)z_info->e_max, (unsigned)z_info->k_max, (unsigned)z_info->r_max,
         (unsigned)z_info->trap_max, (unsigned)flavor_max,
         (unsigned)z_info->pack_size, (unsigned)z_info->quiver_size, (unsigned)z_info->floor_size,
         (unsigned)z_info->quiver_slot_size, (unsigned)z_info->store_inven_max,
         (unsigned)z_info->curse_max, (unsigned)preset_max) <= 0)
     {
-        Destroy_connection(ind, "Send_limits_struct_info write error");
         return -1;
     }
 
@@ -1390,105 +1925,65 @@ int Send_limits_struct_info(int ind)
 }
 
 
-int Send_race_struct_info(int ind)
+static int write_race_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint32_t j;
     struct player_race *r;
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for race info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_RACE,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_RACE,
         (unsigned)player_rmax()) <= 0)
     {
-        Destroy_connection(ind, "Send_race_struct_info write error");
         return -1;
     }
 
     /* Hack -- send limits for client compatibility */
-    if (Packet_printf(&connp->c, "%hd%hd%hd%hd%hd%hd%hd", (int)OBJ_MOD_MAX, (int)SKILL_MAX,
+    if (Packet_printf(sbuf, "%hd%hd%hd%hd%hd%hd%hd", (int)OBJ_MOD_MAX, (int)SKILL_MAX,
         (int)PF_SIZE, (int)PF__MAX, (int)OF_SIZE, (int)OF_MAX, (int)ELEM_MAX) <= 0)
     {
-        Destroy_connection(ind, "Send_race_struct_info write error");
         return -1;
     }
 
     for (r = races; r; r = r->next)
     {
-        if (Packet_printf(&connp->c, "%b%s", r->ridx, r->name) <= 0)
-        {
-            Destroy_connection(ind, "Send_race_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%b%s", r->ridx, r->name) <= 0) return -1;
 
         /* Transfer other fields here */
         for (j = 0; j < OBJ_MOD_MAX; j++)
         {
-            if (Packet_printf(&connp->c, "%hd%hd%hd%hd%b", (int)r->modifiers[j].value.base,
+            if (Packet_printf(sbuf, "%hd%hd%hd%hd%b", (int)r->modifiers[j].value.base,
                 (int)r->modifiers[j].value.dice, (int)r->modifiers[j].value.sides,
                 (int)r->modifiers[j].value.m_bonus, (unsigned)r->modifiers[j].lvl) <= 0)
             {
-                Destroy_connection(ind, "Send_race_struct_info write error");
                 return -1;
             }
         }
         for (j = 0; j < SKILL_MAX; j++)
         {
-            if (Packet_printf(&connp->c, "%hd", (int)r->r_skills[j]) <= 0)
-            {
-                Destroy_connection(ind, "Send_race_struct_info write error");
-                return -1;
-            }
-        }
-        if (Packet_printf(&connp->c, "%b%hd", (unsigned)r->r_mhp, (int)r->r_exp) <= 0)
-        {
-            Destroy_connection(ind, "Send_race_struct_info write error");
-            return -1;
+            if (Packet_printf(sbuf, "%hd", (int)r->r_skills[j]) <= 0) return -1;
         }
+        if (Packet_printf(sbuf, "%b%hd", (unsigned)r->r_mhp, (int)r->r_exp) <= 0) return -1;
         for (j = 0; j < PF_SIZE; j++)
         {
-            if (Packet_printf(&connp->c, "%b", (unsigned)r->pflags[j]) <= 0)
-            {
-                Destroy_connection(ind, "Send_race_struct_info write error");
-                return -1;
-            }
+            if (Packet_printf(sbuf, "%b", (unsigned)r->pflags[j]) <= 0) return -1;
         }
         for (j = 1; j < PF__MAX; j++)
         {
-            if (Packet_printf(&connp->c, "%b", (unsigned)r->pflvl[j]) <= 0)
-            {
-                Destroy_connection(ind, "Send_race_struct_info write error");
-                return -1;
-            }
+            if (Packet_printf(sbuf, "%b", (unsigned)r->pflvl[j]) <= 0) return -1;
         }
         for (j = 0; j < OF_SIZE; j++)
         {
-            if (Packet_printf(&connp->c, "%b", (unsigned)r->flags[j]) <= 0)
-            {
-                Destroy_connection(ind, "Send_race_struct_info write error");
-                return -1;
-            }
+            if (Packet_printf(sbuf, "%b", (unsigned)r->flags[j]) <= 0) return -1;
         }
         for (j = 1; j < OF_MAX; j++)
         {
-            if (Packet_printf(&connp->c, "%b", (unsigned)r->flvl[j]) <= 0)
-            {
-                Destroy_connection(ind, "Send_race_struct_info write error");
-                return -1;
-            }
+            if (Packet_printf(sbuf, "%b", (unsigned)r->flvl[j]) <= 0) return -1;
         }
         for (j = 0; j < ELEM_MAX; j++)
         {
-            if (Packet_printf(&connp->c, "%hd%b%hd%b%hd%b", r->el_info[j].res_level[0],
+            if (Packet_printf(sbuf, "%hd%b%hd%b%hd%b", r->el_info[j].res_level[0],
                 r->el_info[j].lvl[0], r->el_info[j].res_level[1], r->el_info[j].lvl[1],
                 r->el_info[j].res_level[2], r->el_info[j].lvl[2]) <= 0)
             {
-                Destroy_connection(ind, "Send_race_struct_info write error");
                 return -1;
             }
         }
@@ -1498,31 +1993,21 @@ int Send_race_struct_info(int ind)
 }
 
 
-int Send_class_struct_info(int ind)
+static int write_class_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint32_t j;
     struct player_class *c;
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for class info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_CLASS,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_CLASS,
         (unsigned)player_cmax()) <= 0)
     {
-        Destroy_connection(ind, "Send_class_struct_info write error");
         return -1;
     }
 
     /* Hack -- send limits for client compatibility */
-    if (Packet_printf(&connp->c, "%hd%hd%hd%hd%hd%hd%hd", (int)OBJ_MOD_MAX, (int)SKILL_MAX,
+    if (Packet_printf(sbuf, "%hd%hd%hd%hd%hd%hd%hd", (int)OBJ_MOD_MAX, (int)SKILL_MAX,
         (int)PF_SIZE, (int)PF__MAX, (int)OF_SIZE, (int)OF_MAX, (int)ELEM_MAX) <= 0)
     {
-        Destroy_connection(ind, "Send_class_struct_info write error");
         return -1;
     }
 
@@ -1535,92 +2020,60 @@ int Send_class_struct_info(int ind)
         if (c->magic.num_books)
             tval = c->magic.books[0].tval;
 
-        if (Packet_printf(&connp->c, "%b%s", c->cidx, c->name) <= 0)
-        {
-            Destroy_connection(ind, "Send_class_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%b%s", c->cidx, c->name) <= 0) return -1;
 
         /* Transfer other fields here */
         for (j = 0; j < OBJ_MOD_MAX; j++)
         {
-            if (Packet_printf(&connp->c, "%hd%hd%hd%hd%b", (int)c->modifiers[j].value.base,
+            if (Packet_printf(sbuf, "%hd%hd%hd%hd%b", (int)c->modifiers[j].value.base,
                 (int)c->modifiers[j].value.dice, (int)c->modifiers[j].value.sides,
                 (int)c->modifiers[j].value.m_bonus, (unsigned)c->modifiers[j].lvl) <= 0)
             {
-                Destroy_connection(ind, "Send_class_struct_info write error");
                 return -1;
             }
         }
         for (j = 0; j < SKILL_MAX; j++)
         {
-            if (Packet_printf(&connp->c, "%hd", (int)c->c_skills[j]) <= 0)
-            {
-                Destroy_connection(ind, "Send_class_struct_info write error");
-                return -1;
-            }
-        }
-        if (Packet_printf(&connp->c, "%b", (unsigned)c->c_mhp) <= 0)
-        {
-            Destroy_connection(ind, "Send_class_struct_info write error");
-            return -1;
+            if (Packet_printf(sbuf, "%hd", (int)c->c_skills[j]) <= 0) return -1;
         }
+        if (Packet_printf(sbuf, "%b", (unsigned)c->c_mhp) <= 0) return -1;
         for (j = 0; j < PF_SIZE; j++)
         {
-            if (Packet_printf(&connp->c, "%b", (unsigned)c->pflags[j]) <= 0)
-            {
-                Destroy_connection(ind, "Send_class_struct_info write error");
-                return -1;
-            }
+            if (Packet_printf(sbuf, "%b", (unsigned)c->pflags[j]) <= 0) return -1;
         }
         for (j = 1; j < PF__MAX; j++)
         {
-            if (Packet_printf(&connp->c, "%b", (unsigned)c->pflvl[j]) <= 0)
-            {
-                Destroy_connection(ind, "Send_class_struct_info write error");
-                return -1;
-            }
+            if (Packet_printf(sbuf, "%b", (unsigned)c->pflvl[j]) <= 0) return -1;
         }
         for (j = 0; j < OF_SIZE; j++)
         {
-            if (Packet_printf(&connp->c, "%b", (unsigned)c->flags[j]) <= 0)
-            {
-                Destroy_connection(ind, "Send_class_struct_info write error");
-                return -1;
-            }
+            if (Packet_printf(sbuf, "%b", (unsigned)c->flags[j]) <= 0) return -1;
         }
         for (j = 1; j < OF_MAX; j++)
         {
-            if (Packet_printf(&connp->c, "%b", (unsigned)c->flvl[j]) <= 0)
-            {
-                Destroy_connection(ind, "Send_class_struct_info write error");
-                return -1;
-            }
+            if (Packet_printf(sbuf, "%b", (unsigned)c->flvl[j]) <= 0) return -1;
         }
         for (j = 0; j < ELEM_MAX; j++)
         {
-            if (Packet_printf(&connp->c, "%hd%b%hd%b%hd%b", c->el_info[j].res_level[0],
+            if (Packet_printf(sbuf, "%hd%b%hd%b%hd%b", c->el_info[j].res_level[0],
                 c->el_info[j].lvl[0], c->el_info[j].res_level[1], c->el_info[j].lvl[1],
                 c->el_info[j].res_level[2], c->el_info[j].lvl[2]) <= 0)
             {
-                Destroy_connection(ind, "Send_class_struct_info write error");
                 return -1;
             }
         }
-        if (Packet_printf(&connp->c, "%b%hu%hu%c", (unsigned)c->magic.total_spells,
+        if (Packet_printf(sbuf, "%b%hu%hu%c", (unsigned)c->magic.total_spells,
             (unsigned)c->magic.spell_first, (unsigned)tval, c->magic.num_books) <= 0)
         {
-            Destroy_connection(ind, "Send_class_struct_info write error");
             return -1;
         }
         for (j = 0; j < (uint32_t)c->magic.num_books; j++)
         {
             struct class_book *book = &c->magic.books[j];
 
-            if (Packet_printf(&connp->c, "%hu%hu%s", (unsigned)book->tval, (unsigned)book->sval,
+            if (Packet_printf(sbuf, "%hu%hu%s", (unsigned)book->tval, (unsigned)book->sval,
                 book->realm->name) <= 0)
             {
-                Destroy_connection(ind, "Send_class_struct_info write error");
                 return -1;
             }
         }
@@ -1636,10 +2089,9 @@ int Send_class_struct_info(int ind)
                 break;
             }
         }
-        if (Packet_printf(&connp->c, "%hd%hd%hd%hd", (int)weight, (int)c->att_multiply,
+        if (Packet_printf(sbuf, "%hd%hd%hd%hd", (int)weight, (int)c->att_multiply,
             (int)c->max_attacks, (int)c->min_weight) <= 0)
         {
-            Destroy_connection(ind, "Send_class_struct_info write error");
             return -1;
         }
 
@@ -1656,53 +2108,32 @@ int Send_class_struct_info(int ind)
                 slevel = spell->slevel;
             }
         }
-        if (Packet_printf(&connp->c, "%hd%hd", (int)sfail, (int)slevel) <= 0)
-        {
-            Destroy_connection(ind, "Send_class_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%hd%hd", (int)sfail, (int)slevel) <= 0) return -1;
     }
 
     return 1;
 }
 
 
-int Send_body_struct_info(int ind)
+static int write_body_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     int j;
     struct player_body *b;
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for body info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_BODY,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_BODY,
         (unsigned)player_bmax()) <= 0)
     {
-        Destroy_connection(ind, "Send_body_struct_info write error");
         return -1;
     }
 
     for (b = bodies; b; b = b->next)
     {
-        if (Packet_printf(&connp->c, "%hd%s", b->count, b->name) <= 0)
-        {
-            Destroy_connection(ind, "Send_body_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%hd%s", b->count, b->name) <= 0) return -1;
 
         /* Transfer other fields here */
         for (j = 0; j < b->count; j++)
         {
-            if (Packet_printf(&connp->c, "%hd%s", b->slots[j].type, b->slots[j].name) <= 0)
-            {
-                Destroy_connection(ind, "Send_body_struct_info write error");
-                return -1;
-            }
+            if (Packet_printf(sbuf, "%hd%s", b->slots[j].type, b->slots[j].name) <= 0) return -1;
         }
     }
 
@@ -1710,62 +2141,36 @@ int Send_body_struct_info(int ind)
 }
 
 
-int Send_socials_struct_info(int ind)
+static int write_socials_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint32_t i;
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for socials info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_SOCIALS,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_SOCIALS,
         (unsigned)z_info->soc_max) <= 0)
     {
-        Destroy_connection(ind, "Send_socials_struct_info write error");
         return -1;
     }
 
     for (i = 0; i < (uint32_t)z_info->soc_max; i++)
     {
-        if (Packet_printf(&connp->c, "%s", soc_info[i].name) <= 0)
-        {
-            Destroy_connection(ind, "Send_socials_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%s", soc_info[i].name) <= 0) return -1;
 
         /* Transfer other fields here */
-        if (Packet_printf(&connp->c, "%b", (unsigned)soc_info[i].target) <= 0)
-        {
-            Destroy_connection(ind, "Send_socials_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%b", (unsigned)soc_info[i].target) <= 0) return -1;
     }
 
     return 1;
 }
 
 
-int Send_kind_struct_info(int ind)
+static int write_kind_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint32_t i;
     unsigned j;
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for kind info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_KINDS,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_KINDS,
         (unsigned)z_info->k_max) <= 0)
     {
-        Destroy_connection(ind, "Send_kind_struct_info write error");
         return -1;
     }
 
@@ -1776,26 +2181,17 @@ int Send_kind_struct_info(int ind)
         /* Hack -- put flavor index into unused field "ac" */
         if (k_info[i].flavor) ac = (int16_t)k_info[i].flavor->fidx;
 
-        if (Packet_printf(&connp->c, "%s", (k_info[i].name? k_info[i].name: "")) <= 0)
-        {
-            Destroy_connection(ind, "Send_kind_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%s", (k_info[i].name? k_info[i].name: "")) <= 0) return -1;
 
         /* Transfer other fields here */
-        if (Packet_printf(&connp->c, "%hu%hu%lu%hd", (unsigned)k_info[i].tval,
+        if (Packet_printf(sbuf, "%hu%hu%lu%hd", (unsigned)k_info[i].tval,
             (unsigned)k_info[i].sval, k_info[i].kidx, (int)ac) <= 0)
         {
-            Destroy_connection(ind, "Send_kind_struct_info write error");
             return -1;
         }
         for (j = 0; j < KF_SIZE; j++)
         {
-            if (Packet_printf(&connp->c, "%b", (unsigned)k_info[i].kind_flags[j]) <= 0)
-            {
-                Destroy_connection(ind, "Send_kind_struct_info write error");
-                return -1;
-            }
+            if (Packet_printf(sbuf, "%b", (unsigned)k_info[i].kind_flags[j]) <= 0) return -1;
         }
     }
 
@@ -1803,22 +2199,13 @@ int Send_kind_struct_info(int ind)
 }
 
 
-int Send_ego_struct_info(int ind)
+static int write_ego_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint32_t i;
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for ego info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_EGOS,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_EGOS,
         (unsigned)z_info->e_max) <= 0)
     {
-        Destroy_connection(ind, "Send_ego_struct_info write error");
         return -1;
     }
 
@@ -1827,11 +2214,7 @@ int Send_ego_struct_info(int ind)
         uint16_t max = 0;
         struct poss_item *poss;
 
-        if (Packet_printf(&connp->c, "%s", (e_info[i].name? e_info[i].name: "")) <= 0)
-        {
-            Destroy_connection(ind, "Send_ego_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%s", (e_info[i].name? e_info[i].name: "")) <= 0) return -1;
 
         /* Count possible egos */
         poss = e_info[i].poss_items;
@@ -1842,20 +2225,12 @@ int Send_ego_struct_info(int ind)
         }
 
         /* Transfer other fields here */
-        if (Packet_printf(&connp->c, "%lu%hu", e_info[i].eidx, max) <= 0)
-        {
-            Destroy_connection(ind, "Send_ego_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%lu%hu", e_info[i].eidx, max) <= 0) return -1;
 
         poss = e_info[i].poss_items;
         while (poss)
         {
-            if (Packet_printf(&connp->c, "%lu", poss->kidx) <= 0)
-            {
-                Destroy_connection(ind, "Send_ego_struct_info write error");
-                return -1;
-            }
+            if (Packet_printf(sbuf, "%lu", poss->kidx) <= 0) return -1;
 
             poss = poss->next;
         }
@@ -1865,31 +2240,21 @@ int Send_ego_struct_info(int ind)
 }
 
 
-int Send_rinfo_struct_info(int ind)
+static int write_rinfo_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint32_t i;
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for rinfo info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_RINFO,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_RINFO,
         (unsigned)z_info->r_max) <= 0)
     {
-        Destroy_connection(ind, "Send_rinfo_struct_info write error");
         return -1;
     }
 
     for (i = 0; i < (uint32_t)z_info->r_max; i++)
     {
-        if (Packet_printf(&connp->c, "%b%s", r_info[i].d_attr,
+        if (Packet_printf(sbuf, "%b%s", r_info[i].d_attr,
             (r_info[i].name? r_info[i].name: "")) <= 0)
         {
-            Destroy_connection(ind, "Send_rinfo_struct_info write error");
             return -1;
         }
     }
@@ -1898,19 +2263,11 @@ int Send_rinfo_struct_info(int ind)
 }
 
 
-int Send_rbinfo_struct_info(int ind)
+static int write_rbinfo_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint16_t max = 0;
     struct monster_base *mb;
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for rbinfo info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
     /* Count monster base races */
     mb = rb_info;
     while (mb)
@@ -1919,21 +2276,16 @@ int Send_rbinfo_struct_info(int ind)
         mb = mb->next;
     }
 
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_RBINFO,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_RBINFO,
         (unsigned)max) <= 0)
     {
-        Destroy_connection(ind, "Send_rbinfo_struct_info write error");
         return -1;
     }
 
     mb = rb_info;
     while (mb)
     {
-        if (Packet_printf(&connp->c, "%s", mb->name) <= 0)
-        {
-            Destroy_connection(ind, "Send_rbinfo_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%s", mb->name) <= 0) return -1;
 
         mb = mb->next;
     }
@@ -1942,65 +2294,39 @@ int Send_rbinfo_struct_info(int ind)
 }
 
 
-int Send_curse_struct_info(int ind)
+static int write_curse_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint32_t i;
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for curse info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_CURSES,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_CURSES,
         (unsigned)z_info->curse_max) <= 0)
     {
-        Destroy_connection(ind, "Send_curse_struct_info write error");
         return -1;
     }
 
     for (i = 0; i < (uint32_t)z_info->curse_max; i++)
     {
-        if (Packet_printf(&connp->c, "%s", (curses[i].name? curses[i].name: "")) <= 0)
-        {
-            Destroy_connection(ind, "Send_curse_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%s", (curses[i].name? curses[i].name: "")) <= 0) return -1;
 
         /* Transfer other fields here */
-        if (Packet_printf(&connp->c, "%s", (curses[i].desc? curses[i].desc: "")) <= 0)
-        {
-            Destroy_connection(ind, "Send_curse_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%s", (curses[i].desc? curses[i].desc: "")) <= 0) return -1;
     }
 
     return 1;
 }
 
 
-int Send_realm_struct_info(int ind)
+static int write_realm_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint16_t max = 0;
     struct magic_realm *realm;
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for realm info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
     /* Count player magic realms */
     for (realm = realms; realm; realm = realm->next) max++;
 
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_REALM,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_REALM,
         (unsigned)max) <= 0)
     {
-        Destroy_connection(ind, "Send_realm_struct_info write error");
         return -1;
     }
 
@@ -2009,80 +2335,108 @@ int Send_realm_struct_info(int ind)
         const char *spell_noun = (realm->spell_noun? realm->spell_noun: "");
         const char *verb = (realm->verb? realm->verb: "");
 
-        if (Packet_printf(&connp->c, "%s", realm->name) <= 0)
-        {
-            Destroy_connection(ind, "Send_realm_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%s", realm->name) <= 0) return -1;
 
         /* Transfer other fields here */
-        if (Packet_printf(&connp->c, "%hd%s%s", (int)realm->stat, spell_noun, verb) <= 0)
-        {
-            Destroy_connection(ind, "Send_realm_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%hd%s%s", (int)realm->stat, spell_noun, verb) <= 0) return -1;
     }
 
     return 1;
 }
 
 
-int Send_feat_struct_info(int ind)
+static int write_feat_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint32_t i;
 
-    if (connp->state != CONN_SETUP)
-    {
-        errno = 0;
-        plog_fmt("Connection not ready for feat info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
-    }
-
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_FEAT,
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_FEAT,
         (unsigned)FEAT_MAX) <= 0)
     {
-        Destroy_connection(ind, "Send_feat_struct_info write error");
         return -1;
     }
 
     for (i = 0; i < (uint32_t)FEAT_MAX; i++)
     {
-        if (Packet_printf(&connp->c, "%s", (f_info[i].name? f_info[i].name: "")) <= 0)
-        {
-            Destroy_connection(ind, "Send_feat_struct_info write error");
-            return -1;
-        }
+        if (Packet_printf(sbuf, "%s", (f_info[i].name? f_info[i].name: "")) <= 0) return -1;
     }
 
     return 1;
 }
 
 
-int Send_trap_struct_info(int ind)
+static int write_trap_struct_info(sockbuf_t *sbuf)
 {
-    connection_t *connp = get_connection(ind);
     uint32_t i;
 
-    if (connp->state != CONN_SETUP)
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_TRAP,
+        (unsigned)z_info->trap_max) <= 0)
     {
-        errno = 0;
-        plog_fmt("Connection not ready for trap info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
+        return -1;
     }
 
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_TRAP,
-        (unsigned)z_info->trap_max) <= 0)
+    for (i = 0; i < (uint32_t)z_info->trap_max; i++)
+    {
+        if (Packet_printf(sbuf, "%s", (trap_info[i].desc? trap_info[i].desc: "")) <= 0) return -1;
+    }
+
+    return 1;
+}
+
+
+static int write_timed_struct_info(sockbuf_t *sbuf)
+{
+    size_t i;
+    uint8_t dummy = 1;
+    uint8_t dummy1 = 0;
+    int dummy2 = 0;
+    const char *dummy3 = "";
+
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_TIMED,
+        (unsigned)TMD_MAX) <= 0)
+    {
+        return -1;
+    }
+
+    for (i = 0; i < TMD_MAX; i++)
+    {
+        struct timed_effect_data *effect = &timed_effects[i];
+        struct timed_grade *grade = effect->grade;
+
+        while (grade)
+        {
+            if (Packet_printf(sbuf, "%b%b%hd%s", (unsigned)dummy, (unsigned)grade->color,
+                grade->max, (grade->name? grade->name: "")) <= 0)
+            {
+                return -1;
+            }
+            grade = grade->next;
+        }
+    }
+
+    if (Packet_printf(sbuf, "%b%b%hd%s", (unsigned)dummy, (unsigned)dummy1, dummy2, dummy3) <= 0)
+    {
+        return -1;
+    }
+
+    return 1;
+}
+
+
+static int write_abilities_struct_info(sockbuf_t *sbuf)
+{
+    struct player_ability *a;
+
+    if (Packet_printf(sbuf, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_PROPS,
+        (unsigned)player_amax()) <= 0)
     {
-        Destroy_connection(ind, "Send_trap_struct_info write error");
         return -1;
     }
 
-    for (i = 0; i < (uint32_t)z_info->trap_max; i++)
+    for (a = player_abilities; a; a = a->next)
     {
-        if (Packet_printf(&connp->c, "%s", (trap_info[i].desc? trap_info[i].desc: "")) <= 0)
+        if (Packet_printf(sbuf, "%hu%hd%s%s%s", (unsigned)a->index, (int)a->value, a->type,
+            a->desc, a->name) <= 0)
         {
-            Destroy_connection(ind, "Send_trap_struct_info write error");
             return -1;
         }
     }
@@ -2091,83 +2445,138 @@ int Send_trap_struct_info(int ind)
 }
 
 
-int Send_timed_struct_info(int ind)
+/*
+ * Struct info never changes once the server is running, so each setup phase gets its
+ * payload encoded only once. Logins then just copy the bytes into the connection.
+ */
+typedef int (*struct_info_writer)(sockbuf_t *sbuf);
+
+static const struct_info_writer struct_info_phase1[] =
+{
+    write_limits_struct_info,
+    write_kind_struct_info,
+    write_ego_struct_info,
+    write_race_struct_info,
+    write_realm_struct_info,
+    write_class_struct_info,
+    write_body_struct_info,
+    write_socials_struct_info,
+    write_rinfo_struct_info,
+    write_rbinfo_struct_info,
+    write_curse_struct_info,
+    NULL
+};
+
+
+static const struct_info_writer struct_info_phase2[] =
 {
-    connection_t *connp = get_connection(ind);
-    size_t i;
-    uint8_t dummy = 1;
-    uint8_t dummy1 = 0;
-    int dummy2 = 0;
-    const char *dummy3 = "";
+    write_feat_struct_info,
+    NULL
+};
 
-    if (connp->state != CONN_SETUP)
+
+static const struct_info_writer struct_info_phase3[] =
+{
+    write_trap_struct_info,
+    write_timed_struct_info,
+    write_abilities_struct_info,
+    NULL
+};
+
+
+static const struct_info_writer *const struct_info_writers[STRUCT_INFO_PHASES] =
+{
+    struct_info_phase1,
+    struct_info_phase2,
+    struct_info_phase3
+};
+
+
+static struct
+{
+    char *buf;
+    int len;
+} struct_info_blob[STRUCT_INFO_PHASES];
+
+
+static void free_struct_info(void)
+{
+    int i;
+
+    for (i = 0; i < STRUCT_INFO_PHASES; i++)
     {
-        errno = 0;
-        plog_fmt("Connection not ready for timed info (%d.%d.%d)", ind, connp->state, connp->id);
-        return 0;
+        mem_free(struct_info_blob[i].buf);
+        struct_info_blob[i].buf = NULL;
+        struct_info_blob[i].len = 0;
     }
+}
 
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_TIMED,
-        (unsigned)TMD_MAX) <= 0)
-    {
-        Destroy_connection(ind, "Send_timed_struct_info write error");
+
+static int build_struct_info(void)
+{
+    sockbuf_t sbuf;
+    int i, j;
+    char *bufs[STRUCT_INFO_PHASES];
+    int lens[STRUCT_INFO_PHASES];
+
+    /* Same size as the connection buffer it will be copied into */
+    if (Sockbuf_init(&sbuf, -1, SERVER_SEND_SIZE, SOCKBUF_WRITE | SOCKBUF_LOCK) == -1)
         return -1;
-    }
 
-    for (i = 0; i < TMD_MAX; i++)
+    /* Build everything first, so the current struct info is kept on failure */
+    for (i = 0; i < STRUCT_INFO_PHASES; i++)
     {
-        struct timed_effect_data *effect = &timed_effects[i];
-        struct timed_grade *grade = effect->grade;
-
-        while (grade)
+        Sockbuf_clear(&sbuf);
+        for (j = 0; struct_info_writers[i][j]; j++)
         {
-            if (Packet_printf(&connp->c, "%b%b%hd%s", (unsigned)dummy, (unsigned)grade->color,
-                grade->max, (grade->name? grade->name: "")) <= 0)
+            if (struct_info_writers[i][j](&sbuf) <= 0)
             {
-                Destroy_connection(ind, "Send_timed_struct_info write error");
+                plog_fmt("Struct info too big for phase %d", i + 1);
+                Sockbuf_cleanup(&sbuf);
+                while (i--) mem_free(bufs[i]);
                 return -1;
             }
-            grade = grade->next;
         }
+
+        bufs[i] = mem_alloc(sbuf.len);
+        memcpy(bufs[i], sbuf.buf, sbuf.len);
+        lens[i] = sbuf.len;
     }
+    Sockbuf_cleanup(&sbuf);
 
-    if (Packet_printf(&connp->c, "%b%b%hd%s", (unsigned)dummy, (unsigned)dummy1, dummy2, dummy3) <= 0)
+    free_struct_info();
+    for (i = 0; i < STRUCT_INFO_PHASES; i++)
     {
-        Destroy_connection(ind, "Send_timed_struct_info write error");
-        return -1;
+        struct_info_blob[i].buf = bufs[i];
+        struct_info_blob[i].len = lens[i];
     }
+    MD5Digest(struct_info_hash, bufs, lens, STRUCT_INFO_PHASES);
 
-    return 1;
+    return 0;
 }
 
 
-int Send_abilities_struct_info(int ind)
+int Send_struct_info(int ind, int phase)
 {
     connection_t *connp = get_connection(ind);
-    struct player_ability *a;
 
     if (connp->state != CONN_SETUP)
     {
         errno = 0;
-        plog_fmt("Connection not ready for abilities info (%d.%d.%d)", ind, connp->state, connp->id);
+        plog_fmt("Connection not ready for struct info (%d.%d.%d)", ind, connp->state, connp->id);
         return 0;
     }
 
-    if (Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_STRUCT_INFO, (int)STRUCT_INFO_PROPS,
-        (unsigned)player_amax()) <= 0)
-    {
-        Destroy_connection(ind, "Send_abilities_struct_info write error");
-        return -1;
-    }
+    traffic_mark(connp);
 
-    for (a = player_abilities; a; a = a->next)
+    /* The client already has it */
+    if (connp->struct_cached) return 1;
+
+    if (Sockbuf_write(&connp->c, struct_info_blob[phase].buf, struct_info_blob[phase].len) !=
+        struct_info_blob[phase].len)
     {
-        if (Packet_printf(&connp->c, "%hu%hd%s%s%s", (unsigned)a->index, (int)a->value, a->type,
-            a->desc, a->name) <= 0)
-        {
-            Destroy_connection(ind, "Send_abilities_struct_info write error");
-            return -1;
-        }
+        Destroy_connection(ind, "Send_struct_info write error");
+        return -1;
     }
 
     return 1;
@@ -2193,6 +2602,7 @@ static connection_t *get_connp(struct player *p, const char *errmsg)
         return NULL;
     }
 
+    traffic_mark(connp);
     return connp;
 }
 
@@ -2221,82 +2631,117 @@ int Send_winner(struct player *p)
 int Send_lvl(struct player *p, int lev, int mlev)
 {
     connection_t *connp = get_connp(p, "level");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_LEV, lev, mlev);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_LVL, start,
+        Packet_write_lvl(&connp->c, lev, mlev));
 }
 
 
 int Send_weight(struct player *p, int weight, int max_weight)
 {
     connection_t *connp = get_connp(p, "weight");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_WEIGHT, weight, max_weight);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_WEIGHT, start,
+        Packet_write_weight(&connp->c, weight, max_weight));
 }
 
 
 int Send_plusses(struct player *p, int dd, int ds, int mhit, int mdam, int shit, int sdam)
 {
     connection_t *connp = get_connp(p, "plusses");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd%hd%hd%hd%hd", (unsigned)PKT_PLUSSES, dd, ds, mhit,
-        mdam, shit, sdam);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_PLUSSES, start,
+        Packet_write_plusses(&connp->c, dd, ds, mhit, mdam, shit, sdam));
 }
 
 
 int Send_ac(struct player *p, int base, int plus)
 {
     connection_t *connp = get_connp(p, "ac");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_AC, base, plus);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_AC, start,
+        Packet_write_ac(&connp->c, base, plus));
 }
 
 
 int Send_exp(struct player *p, int32_t max, int32_t cur, int16_t expfact)
 {
     connection_t *connp = get_connp(p, "exp");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%ld%ld%hd", (unsigned)PKT_EXP, max, cur, expfact);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_EXP, start,
+        Packet_write_exp(&connp->c, max, cur, expfact));
 }
 
 
 int Send_gold(struct player *p, int32_t au)
 {
     connection_t *connp = get_connp(p, "gold");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%ld", (unsigned)PKT_GOLD, au);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_GOLD, start,
+        Packet_write_gold(&connp->c, au));
 }
 
 
 int Send_hp(struct player *p, int mhp, int chp)
 {
     connection_t *connp = get_connp(p, "hp");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_HP, mhp, chp);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_HP, start,
+        Packet_write_hp(&connp->c, mhp, chp));
 }
 
 
 int Send_sp(struct player *p, int msp, int csp)
 {
     connection_t *connp = get_connp(p, "sp");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_SP, msp, csp);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_SP, start,
+        Packet_write_sp(&connp->c, msp, csp));
 }
 
 
 int Send_various(struct player *p, int hgt, int wgt, int age)
 {
     connection_t *connp = get_connp(p, "various");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd%hd", (unsigned)PKT_VARIOUS, hgt, wgt, age);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_VARIOUS, start,
+        Packet_write_various(&connp->c, hgt, wgt, age));
 }
 
 
@@ -2304,10 +2749,13 @@ int Send_stat(struct player *p, int stat, int stat_top, int stat_use,
     int stat_max, int stat_add, int stat_cur)
 {
     connection_t *connp = get_connp(p, "stat");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%c%hd%hd%hd%hd%hd", (unsigned)PKT_STAT, stat, stat_top,
-        stat_use, stat_max, stat_add, stat_cur);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_STAT + stat, start,
+        Packet_write_stat(&connp->c, stat, stat_top, stat_use, stat_max, stat_add, stat_cur));
 }
 
 
@@ -2339,7 +2787,7 @@ int Send_index(struct player *p, int i, int index, uint8_t type)
     connection_t *connp = get_connp(p, "index");
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd%b", (unsigned)PKT_INDEX, i, index, (unsigned)type);
+    return Packet_write_index(&connp->c, i, index, (unsigned)type);
 }
 
 
@@ -2356,29 +2804,39 @@ int Send_item_request(struct player *p, uint8_t tester_hook, char *dice_string)
 int Send_title(struct player *p, const char *title)
 {
     connection_t *connp = get_connp(p, "title");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%s", (unsigned)PKT_TITLE, title);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_TITLE, start,
+        Packet_printf(&connp->c, "%b%s", (unsigned)PKT_TITLE, title));
 }
 
 
 int Send_turn(struct player *p, uint32_t game_turn, uint32_t player_turn, uint32_t active_turn)
 {
     connection_t *connp = get_connp(p, "turn");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%lu%lu%lu", (unsigned)PKT_TURN, game_turn, player_turn,
-        active_turn);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_TURN, start,
+        Packet_write_turn(&connp->c, game_turn, player_turn, active_turn));
 }
 
 
 int Send_extra(struct player *p)
 {
     connection_t *connp = get_connp(p, "extra");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%b%b", (unsigned)PKT_EXTRA, (unsigned)p->cannot_cast,
-        (unsigned)p->cannot_cast_mimic);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_EXTRA, start,
+        Packet_write_extra(&connp->c, (unsigned)p->cannot_cast, (unsigned)p->cannot_cast_mimic));
 }
 
 
@@ -2387,49 +2845,59 @@ int Send_depth(struct player *p)
     uint8_t daytime;
 
     connection_t *connp = get_connp(p, "depth");
+    int start;
+
     if (connp == NULL) return 0;
 
     daytime = (is_daytime()? 1: 0);
 
-    return Packet_printf(&connp->c, "%b%b%hd%hd%s%s", (unsigned)PKT_DEPTH, (unsigned)daytime,
-        p->wpos.depth, p->max_depth, p->depths, p->locname);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_DEPTH, start,
+        Packet_printf(&connp->c, "%b%b%hd%hd%s%s", (unsigned)PKT_DEPTH, (unsigned)daytime,
+        p->wpos.depth, p->max_depth, p->depths, p->locname));
 }
 
 
 int Send_status(struct player *p, int16_t *effects)
 {
-    int i;
-
     connection_t *connp = get_connp(p, "blind");
-    if (connp == NULL) return 0;
+    int start;
 
-    Packet_printf(&connp->c, "%b", (unsigned)PKT_STATUS);
+    if (connp == NULL) return 0;
 
-    for (i = 0; i < TMD_MAX; i++)
-        Packet_printf(&connp->c, "%hd", (int)effects[i]);
+    start = connp->c.len;
+    Packet_write_status(&connp->c);
+    Packet_write_hd_array(&connp->c, effects, TMD_MAX);
 
-    return 1;
+    return status_shadow_check(connp, STATUS_EFFECTS, start, 1);
 }
 
 
 int Send_recall(struct player *p, int16_t word_recall, int16_t deep_descent)
 {
     connection_t *connp = get_connp(p, "recall");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_RECALL, (int)word_recall,
-        (int)deep_descent);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_RECALL, start,
+        Packet_write_recall(&connp->c, (int)word_recall, (int)deep_descent));
 }
 
 
 int Send_state(struct player *p, bool stealthy, bool resting, bool unignoring, const char *terrain)
 {
     connection_t *connp = get_connp(p, "state");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd%hd%hd%hd%hd%hd%s", (unsigned)PKT_STATE, (int)stealthy,
-        (int)resting, (int)unignoring, (int)p->obj_feeling, (int)p->mon_feeling,
-        (int)p->square_light, p->state.num_moves, terrain);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_STATE, start,
+        Packet_printf(&connp->c, "%b%hd%hd%hd%hd%hd%hd%hd%s", (unsigned)PKT_STATE,
+        (int)stealthy, (int)resting, (int)unignoring, (int)p->obj_feeling, (int)p->mon_feeling,
+        (int)p->square_light, p->state.num_moves, terrain));
 }
 
 
@@ -2481,7 +2949,7 @@ static int rle_encode(sockbuf_t* buf, cave_view_type* lineref, int max_col, int
             a |= 0x8000;
 
             /* Output the info */
-            Packet_printf(buf, "%c%hu%hu", (int)c, (unsigned)a, (unsigned)n);
+            Packet_write_grid_run(buf, (int)c, (unsigned)a, (unsigned)n);
 
             /* Start again after the run */
             i = x1 - 1;
@@ -2497,7 +2965,7 @@ static int rle_encode(sockbuf_t* buf, cave_view_type* lineref, int max_col, int
             a |= 0x40;
 
             /* Output the info */
-            Packet_printf(buf, "%c%hu%hu", (int)c, (unsigned)a, (unsigned)n);
+            Packet_write_grid_run(buf, (int)c, (unsigned)a, (unsigned)n);
 
             /* Start again after the run */
             i = x1 - 1;
@@ -2510,7 +2978,7 @@ static int rle_encode(sockbuf_t* buf, cave_view_type* lineref, int max_col, int
         else
         {
             /* Output the info */
-            Packet_printf(buf, "%c%hu", (int)c, (unsigned)a);
+            Packet_write_grid(buf, (int)c, (unsigned)a);
 
             /* Count bytes */
             b += 3;
@@ -2577,6 +3045,147 @@ static connection_t* get_mind_link(struct player *p)
 }
 
 
+/*
+ * Shared frames
+ *
+ * A map row is encoded once into "frame" and copied to every connection that displays it the
+ * same way (the player, a mind-linked player, spectators) instead of being encoded for each.
+ * "frame_key" tells which row encoding the frame currently holds.
+ */
+#define FRAME_NONE  -1
+static int frame_key = FRAME_NONE;
+
+
+/*
+ * Encode a map row as sent in PKT_LINE_INFO: the transparency layer if the client is in
+ * graphics mode, then the attr/char stream
+ */
+static void frame_line(struct player *p, int y, int wid, bool graphics)
+{
+    int key = (wid << 1) | (graphics? 1: 0);
+
+    if (frame_key == key) return;
+
+    Sockbuf_clear(&frame);
+    if (graphics) rle_encode(&frame, p->trn_info[y], wid, RLE_LARGE);
+    rle_encode(&frame, p->scr_info[y], wid, (graphics? RLE_LARGE: RLE_CLASSIC));
+    frame_key = key;
+}
+
+
+/*
+ * Plain text version of a map grid (tiles don't make sense as text)
+ */
+static char text_char(cave_view_type *grid)
+{
+    if (grid->c == 0) return ' ';
+    if (isprint((unsigned char)grid->c)) return grid->c;
+    return '?';
+}
+
+
+/*
+ * Encode a map row as plain text for spectators, positioned with an ANSI cursor move
+ */
+static void frame_text(struct player *p, int y)
+{
+    int x, wid = p->screen_cols / p->tile_wid;
+
+    frame.len = strnfmt(frame.buf, frame.size, "\033[%d;1H", y + 1);
+    for (x = 0; x < wid; x++) frame.buf[frame.len++] = text_char(&p->scr_info[y][x]);
+    frame_key = FRAME_NONE;
+}
+
+
+/*
+ * Encode the grids of a map row marked by Queue_char() as plain text for spectators
+ *
+ * The rest of the row isn't sent since "scr_info" may hold something else by now.
+ */
+static void frame_text_grids(struct player *p, int y, bitflag *dirty)
+{
+    int x;
+
+    Sockbuf_clear(&frame);
+    for (x = flag_next(dirty, SCR_DIRTY_SIZE, FLAG_START);
+        (x != FLAG_END) && (frame.len < frame.size - 16);
+        x = flag_next(dirty, SCR_DIRTY_SIZE, x + 1))
+    {
+        frame.len += strnfmt(frame.buf + frame.len, frame.size - frame.len, "\033[%d;%dH%c",
+            y + 1, x - FLAG_START + 1, text_char(&p->scr_info[y][x - FLAG_START]));
+    }
+    frame_key = FRAME_NONE;
+}
+
+
+static int frame_send(sockbuf_t *sbuf)
+{
+    return Sockbuf_write(sbuf, frame.buf, frame.len);
+}
+
+
+/*
+ * Send the text frame to the spectators of a player
+ */
+static void Send_watchers_frame(connection_t *connp)
+{
+    int ind, next;
+
+    for (ind = connp->watchers; ind != -1; ind = next)
+    {
+        connection_t *spectator = get_connection(ind);
+
+        next = spectator->next_watcher;
+
+        /* Drop spectators that can't keep up */
+        if (frame_send(&spectator->w) != frame.len) unwatch(ind);
+    }
+}
+
+
+/*
+ * Flush the map rows sent to the spectators of a player this turn
+ */
+static void Flush_watchers(connection_t *connp)
+{
+    int ind, next;
+
+    for (ind = connp->watchers; ind != -1; ind = next)
+    {
+        connection_t *spectator = get_connection(ind);
+
+        next = spectator->next_watcher;
+        if (Sockbuf_flush(&spectator->w) == -1) unwatch(ind);
+    }
+}
+
+
+/*
+ * Make a console connection watch the map of a player (or stop watching if "p" is NULL)
+ */
+bool Conn_watch(int ind, struct player *p)
+{
+    connection_t *connp = get_connection(ind), *target;
+
+    unwatch(ind);
+    if (!p) return true;
+
+    target = get_connection(p->conn);
+    if (target->state != CONN_PLAYING) return false;
+
+    connp->watching = p->conn;
+    connp->next_watcher = target->watchers;
+    target->watchers = ind;
+
+    /* Start with the whole map */
+    Sockbuf_write(&connp->w, "\033[2J", 4);
+    Sockbuf_flush(&connp->w);
+    p->upkeep->redraw |= PR_MAP;
+
+    return true;
+}
+
+
 /*
  * As an attempt to lower bandwidth requirements, each line is run length
  * encoded.  Non-encoded grids are sent as normal, but if a grid is
@@ -2589,6 +3198,7 @@ int Send_line_info(struct player *p, int y)
     struct player *p_ptr2 = NULL;
     connection_t *connp, *connp2;
     int screen_wid, screen_wid2 = 0;
+    bool delta;
 
     connp = get_connp(p, "line info");
     if (connp == NULL) return 0;
@@ -2598,28 +3208,47 @@ int Send_line_info(struct player *p, int y)
     connp2 = get_mind_link(p);
     if (connp2)
     {
+        traffic_mark(connp2);
         p_ptr2 = find_player(p->esp_link);
         screen_wid2 = p_ptr2->screen_cols / p_ptr2->tile_wid;
     }
 
+    /* Send only the grids that changed if the client supports it */
+    delta = ((y >= 0) && line_delta(connp, p, y, screen_wid));
+
     /* Put a header on the packet */
-    Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_LINE_INFO, y, screen_wid);
+    if (!delta)
+        Packet_write_line_info(&connp->c, y, screen_wid);
     if (connp2)
-        Packet_printf(&connp2->c, "%b%hd%hd", (unsigned)PKT_LINE_INFO, y, screen_wid2);
+        Packet_write_line_info(&connp2->c, y, screen_wid2);
 
     /* Reset the line counter */
     if (y == -1) return 1;
 
-    /* Encode and send the transparency attr/char stream */
-    if (p->use_graphics)
-        rle_encode(&connp->c, p->trn_info[y], screen_wid, RLE_LARGE);
-    if (connp2 && p_ptr2->use_graphics)
-        rle_encode(&connp2->c, p->trn_info[y], screen_wid2, RLE_LARGE);
+    /* Our rows replace the ones of the mind-linked player */
+    if (connp2) line_shadow_reset(connp2);
 
-    /* Encode and send the attr/char stream */
-    rle_encode(&connp->c, p->scr_info[y], screen_wid, DUNGEON_RLE_MODE(p));
+    /* Encode the row once, the mind-linked player usually displays it the same way */
+    frame_key = FRAME_NONE;
+    if (!delta)
+    {
+        frame_line(p, y, screen_wid, p->use_graphics);
+        frame_send(&connp->c);
+        line_shadow_store(connp, p, y, screen_wid);
+    }
     if (connp2)
-        rle_encode(&connp2->c, p->scr_info[y], screen_wid2, DUNGEON_RLE_MODE(p_ptr2));
+    {
+        frame_line(p, y, screen_wid2, p_ptr2->use_graphics);
+        frame_send(&connp2->c);
+    }
+    if (connp->watchers != -1)
+    {
+        frame_text(p, y);
+        Send_watchers_frame(connp);
+    }
+
+    /* The row is up to date */
+    flag_wipe(p->scr_dirty[y], SCR_DIRTY_SIZE);
 
     return 1;
 }
@@ -2630,8 +3259,11 @@ int Send_remote_line(struct player *p, int y)
     connection_t *connp = get_connp(p, "remote line");
     if (connp == NULL) return 0;
 
+    /* Rows sent to the main terminal overwrite the map */
+    if (p->remote_term == NTERM_WIN_OVERHEAD) line_shadow_reset(connp);
+
     /* Packet header */
-    Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_LINE_INFO, y, NORMAL_WID);
+    Packet_write_line_info(&connp->c, y, NORMAL_WID);
 
     /* Packet body */
     rle_encode(&connp->c, p->info[y], NORMAL_WID, DUNGEON_RLE_MODE(p));
@@ -2643,18 +3275,26 @@ int Send_remote_line(struct player *p, int y)
 int Send_speed(struct player *p, int speed, int mult)
 {
     connection_t *connp = get_connp(p, "speed");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_SPEED, speed, mult);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_SPEED, start,
+        Packet_write_speed(&connp->c, speed, mult));
 }
 
 
 int Send_study(struct player *p, int study, bool can_study_book)
 {
     connection_t *connp = get_connp(p, "study");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%c", (unsigned)PKT_STUDY, study, (int)can_study_book);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_STUDY, start,
+        Packet_write_study(&connp->c, study, (int)can_study_book));
 }
 
 
@@ -2663,7 +3303,7 @@ int Send_count(struct player *p, uint8_t type, int16_t count)
     connection_t *connp = get_connp(p, "count");
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%b%hd", (unsigned)PKT_COUNT, (unsigned)type, (int)count);
+    return Packet_write_count(&connp->c, (unsigned)type, (int)count);
 }
 
 
@@ -2672,8 +3312,71 @@ int Send_show_floor(struct player *p, uint8_t mode)
     connection_t *connp = get_connp(p, "show_floor");
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%b", (unsigned)PKT_SHOW_FLOOR,
-        (unsigned)mode);
+    return Packet_write_show_floor(&connp->c, (unsigned)mode);
+}
+
+
+/*
+ * Mark a grid of the map to be sent at the end of the turn
+ *
+ * The grid is read from "scr_info" and "trn_info" when sent, so a grid that changes
+ * several times during a turn is only sent once.
+ */
+void Queue_char(struct player *p, struct loc *grid)
+{
+    flag_on(p->scr_dirty[grid->y], SCR_DIRTY_SIZE, grid->x + FLAG_START);
+    p->scr_dirty_any = true;
+}
+
+
+/*
+ * Send the grids marked by Queue_char()
+ *
+ * Clients that support it get spans of adjacent grids, others a PKT_CHAR per grid.
+ */
+void Send_queued_chars(struct player *p)
+{
+    connection_t *connp;
+    int y, x, screen_wid;
+    bool playing, spans;
+
+    if (!p->scr_dirty_any) return;
+    p->scr_dirty_any = false;
+
+    connp = get_connection(p->conn);
+    playing = (connp->state == CONN_PLAYING);
+    screen_wid = p->screen_cols / p->tile_wid;
+
+    /* Mind-linked clients only understand single grids */
+    spans = (playing && line_shadow_usable(connp, p) && (screen_wid <= 255) && !get_mind_link(p));
+
+    for (y = 0; y < z_info->dungeon_hgt + ROW_MAP + 1; y++)
+    {
+        bitflag *dirty = p->scr_dirty[y];
+
+        if (flag_is_empty(dirty, SCR_DIRTY_SIZE)) continue;
+
+        if (connp->watchers != -1)
+        {
+            frame_text_grids(p, y, dirty);
+            Send_watchers_frame(connp);
+        }
+
+        if (playing && (!spans || !line_spans(connp, p, y, dirty, SCR_DIRTY_SIZE, screen_wid)))
+        {
+            for (x = flag_next(dirty, SCR_DIRTY_SIZE, FLAG_START); x != FLAG_END;
+                x = flag_next(dirty, SCR_DIRTY_SIZE, x + 1))
+            {
+                struct loc disp;
+
+                loc_init(&disp, x - FLAG_START, y);
+                Send_char(p, &disp, p->scr_info[y][disp.x].a, p->scr_info[y][disp.x].c,
+                    p->trn_info[y][disp.x].a, p->trn_info[y][disp.x].c);
+            }
+        }
+
+        flag_wipe(dirty, SCR_DIRTY_SIZE);
+    }
 }
 
 
@@ -2697,31 +3400,38 @@ int Send_char(struct player *p, struct loc *grid, uint16_t a, char c, uint16_t t
 
         return 0;
     }
+    traffic_mark(connp);
 
     connp2 = get_mind_link(p);
     if (connp2 && (connp2->state == CONN_PLAYING))
     {
         struct player *p_ptr2 = find_player(p->esp_link);
 
+        traffic_mark(connp2);
+
+        line_shadow_reset(connp2);
+
         if (p_ptr2->use_graphics && (p_ptr2->remote_term == NTERM_WIN_OVERHEAD))
         {
-            Packet_printf(&connp2->c, "%b%b%b%hu%c%hu%c", (unsigned)PKT_CHAR, (unsigned)grid->x,
-                (unsigned)grid->y, (unsigned)a, (int)c, (unsigned)ta, (int)tc);
+            Packet_write_char_trn(&connp2->c, (unsigned)grid->x, (unsigned)grid->y, (unsigned)a,
+                (int)c, (unsigned)ta, (int)tc);
         }
         else
         {
-            Packet_printf(&connp2->c, "%b%b%b%hu%c", (unsigned)PKT_CHAR, (unsigned)grid->x,
-                (unsigned)grid->y, (unsigned)a, (int)c);
+            Packet_write_char(&connp2->c, (unsigned)grid->x, (unsigned)grid->y, (unsigned)a,
+                (int)c);
         }
     }
 
+    line_shadow_grid(connp, p, grid, a, c, ta, tc);
+
     if (p->use_graphics && (p->remote_term == NTERM_WIN_OVERHEAD))
     {
-        return Packet_printf(&connp->c, "%b%b%b%hu%c%hu%c", (unsigned)PKT_CHAR, (unsigned)grid->x,
-            (unsigned)grid->y, (unsigned)a, (int)c, (unsigned)ta, (int)tc);
+        return Packet_write_char_trn(&connp->c, (unsigned)grid->x, (unsigned)grid->y,
+            (unsigned)a, (int)c, (unsigned)ta, (int)tc);
     }
-    return Packet_printf(&connp->c, "%b%b%b%hu%c", (unsigned)PKT_CHAR, (unsigned)grid->x,
-        (unsigned)grid->y, (unsigned)a, (int)c);
+    return Packet_write_char(&connp->c, (unsigned)grid->x, (unsigned)grid->y, (unsigned)a,
+        (int)c);
 }
 
 
@@ -2830,7 +3540,7 @@ int Send_sound(struct player *p, int sound)
     connection_t *connp = get_connp(p, "sound");
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd", (unsigned)PKT_SOUND, (int)sound);
+    return Packet_write_sound(&connp->c, (int)sound);
 }
 
 
@@ -2839,8 +3549,11 @@ int Send_mini_map(struct player *p, int y, int16_t w)
     connection_t *connp = get_connp(p, "mini map");
     if (connp == NULL) return 0;
 
+    /* Rows sent to the main terminal overwrite the map */
+    if (p->remote_term == NTERM_WIN_OVERHEAD) line_shadow_reset(connp);
+
     /* Packet header */
-    Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_MINI_MAP, y, (int)w);
+    Packet_write_mini_map(&connp->c, y, (int)w);
 
     /* Reset the line counter */
     if (y == -1) return 1;
@@ -2904,10 +3617,13 @@ int Send_pause(struct player *p)
 int Send_monster_health(struct player *p, int num, uint8_t attr)
 {
     connection_t *connp = get_connp(p, "monster health");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%c%b", (unsigned)PKT_MONSTER_HEALTH,
-        num, (unsigned)attr);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_HEALTH, start,
+        Packet_write_monster_health(&connp->c, num, (unsigned)attr));
 }
 
 
@@ -2979,8 +3695,7 @@ int Send_cursor(struct player *p, char vis, char x, char y)
     connection_t *connp = get_connp(p, "cursor");
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%c%c%c", (unsigned)PKT_CURSOR,
-        (int)vis, (int)x, (int)y);
+    return Packet_write_cursor(&connp->c, (int)vis, (int)x, (int)y);
 }
 
 
@@ -3012,9 +3727,13 @@ int Send_spell_desc(struct player *p, int book, int i, char *out_desc, char *out
 int Send_dtrap(struct player *p, uint8_t dtrap)
 {
     connection_t *connp = get_connp(p, "dtrap");
+    int start;
+
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%b", (unsigned)PKT_DTRAP, (unsigned)dtrap);
+    start = connp->c.len;
+    return status_shadow_check(connp, STATUS_DTRAP, start,
+        Packet_write_dtrap(&connp->c, (unsigned)dtrap));
 }
 
 
@@ -3023,14 +3742,21 @@ int Send_term_info(struct player *p, int mode, uint16_t arg)
     connection_t *connp = get_connp(p, "term info");
     if (connp == NULL) return 0;
 
+    /* Clearing the screen erases the map, send it in full the next time */
+    if ((mode == NTERM_CLEAR) && (arg == 1)) line_shadow_reset(connp);
+
     /* Hack -- do not change terms too often */
     if (mode == NTERM_ACTIVATE)
     {
         if (p->remote_term == (uint8_t)arg) return 1;
+
+        /* Queued grids belong to the main terminal */
+        if (p->remote_term == NTERM_WIN_OVERHEAD) Send_queued_chars(p);
+
         p->remote_term = (uint8_t)arg;
     }
 
-    return Packet_printf(&connp->c, "%b%c%hu", (unsigned)PKT_TERM, mode, (unsigned)arg);
+    return Packet_write_term(&connp->c, mode, (unsigned)arg);
 }
 
 
@@ -3039,8 +3765,8 @@ int Send_player_pos(struct player *p)
     connection_t *connp = get_connp(p, "player pos");
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd%hd%hd", (unsigned)PKT_PLAYER, (int)p->grid.x,
-        (int)p->offset_grid.x, (int)p->grid.y, (int)p->offset_grid.y);
+    return Packet_write_player_pos(&connp->c, (int)p->grid.x, (int)p->offset_grid.x,
+        (int)p->grid.y, (int)p->offset_grid.y);
 }
 
 
@@ -3049,7 +3775,7 @@ int Send_minipos(struct player *p, int y, int x, bool self, int n)
     connection_t *connp = get_connp(p, "minipos");
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->c, "%b%hd%hd%hd%hd", (unsigned)PKT_MINIPOS, y, x, (int)self, n);
+    return Packet_write_minipos(&connp->c, y, x, (int)self, n);
 }
 
 
@@ -3064,6 +3790,8 @@ int Send_play(int ind)
         return 0;
     }
 
+    traffic_mark(connp);
+
     return Packet_printf(&connp->c, "%b", (unsigned)PKT_PLAY);
 }
 
@@ -3072,6 +3800,7 @@ int Send_features(int ind, int lighting, int off)
 {
     connection_t *connp = get_connection(ind);
 
+    traffic_mark(connp);
     if (Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_FEATURES, lighting, off) <= 0)
     {
         Destroy_connection(ind, "Send_features write error");
@@ -3082,31 +3811,29 @@ int Send_features(int ind, int lighting, int off)
 }
 
 
+/*
+ * Send a chunk of a text screen, the whole screen at once for current clients (older ones
+ * keep asking for the rest at "offset" + "max")
+ */
 int Send_text_screen(int ind, int type, int32_t offset)
 {
     connection_t *connp = get_connection(ind);
-    int i;
     int32_t max;
 
+    if ((offset < 0) || (offset > TEXTFILE__WID * TEXTFILE__HGT))
+        offset = TEXTFILE__WID * TEXTFILE__HGT;
     max = MAX_TEXTFILE_CHUNK;
     if (offset + max > TEXTFILE__WID * TEXTFILE__HGT) max = TEXTFILE__WID * TEXTFILE__HGT - offset;
-    if (offset > TEXTFILE__WID * TEXTFILE__HGT) offset = TEXTFILE__WID * TEXTFILE__HGT;
 
-    if (Packet_printf(&connp->c, "%b%hd%ld%ld", (unsigned)PKT_TEXT_SCREEN, type, max, offset) <= 0)
+    traffic_mark(connp);
+    if ((Packet_printf(&connp->c, "%b%hd%ld%ld", (unsigned)PKT_TEXT_SCREEN, type, max,
+        offset) <= 0) ||
+        (Packet_write_bytes(&connp->c, &Setup.text_screen[type][offset], max) < 0))
     {
         Destroy_connection(ind, "Send_text_screen write error");
         return -1;
     }
 
-    for (i = offset; i < offset + max; i++)
-    {
-        if (Packet_printf(&connp->c, "%c", (int)Setup.text_screen[type][i]) <= 0)
-        {
-            Destroy_connection(ind, "Send_text_screen write error");
-            return -1;
-        }
-    }
-
     return 1;
 }
 
@@ -3122,6 +3849,8 @@ int Send_char_info_conn(int ind)
         return 0;
     }
 
+    traffic_mark(connp);
+
     return Packet_printf(&connp->c, "%b%b%b%b%b", (unsigned)PKT_CHAR_INFO,
         (unsigned)connp->char_state, (unsigned)connp->ridx, (unsigned)connp->cidx,
         (unsigned)connp->psex);
@@ -3149,6 +3878,8 @@ int Send_birth_options(int ind, struct birth_options *options)
         return 0;
     }
 
+    traffic_mark(connp);
+
     return Packet_printf(&connp->c, "%b%c%c%c%c%c%c%c%c%c", (unsigned)PKT_OPTIONS,
         (int)options->force_descend, (int)options->no_recall, (int)options->no_artifacts,
         (int)options->feelings, (int)options->no_selling, (int)options->start_kit,
@@ -3181,11 +3912,15 @@ bool Send_dump_character(connection_t *connp, const char *dumpname, int mode)
         case 1: tok = "BEGIN_NORMAL_DUMP"; break;
         case 2: tok = "BEGIN_MANUAL_DUMP"; break;
     }
+    traffic_mark(connp);
     Packet_printf(&connp->c, "%b%s", (unsigned)PKT_CHAR_DUMP, tok);
 
     /* Process the file */
     while (file_getl(fp, buf, sizeof(buf)))
+    {
+        traffic_mark(connp);
         Packet_printf(&connp->c, "%b%s", (unsigned)PKT_CHAR_DUMP, buf);
+    }
 
     /* End sending */
     switch (mode)
@@ -3193,6 +3928,7 @@ bool Send_dump_character(connection_t *connp, const char *dumpname, int mode)
         case 1: tok = "END_NORMAL_DUMP"; break;
         case 2: tok = "END_MANUAL_DUMP"; break;
     }
+    traffic_mark(connp);
     Packet_printf(&connp->c, "%b%s", (unsigned)PKT_CHAR_DUMP, tok);
 
     /* Close the file */
@@ -3299,6 +4035,9 @@ int Send_fullmap(struct player *p, int y)
     connection_t *connp = get_connp(p, "full map");
     if (connp == NULL) return 0;
 
+    /* The full map overwrites the rows of the map */
+    line_shadow_reset(connp);
+
     /* Packet header */
     Packet_printf(&connp->c, "%b%hd", (unsigned)PKT_FULLMAP, y);
 
@@ -3390,7 +4129,10 @@ int Send_flush(struct player *p, bool fresh, char delay)
     /* Hack -- don't display animations if fire_till_kill is enabled */
     if (p->firing_request) delay = 0;
 
-    return Packet_printf(&connp->c, "%b%c%c", (unsigned)PKT_FLUSH, (int)fresh, (int)delay);
+    /* Show the grids changed so far in this frame */
+    Send_queued_chars(p);
+
+    return Packet_write_flush(&connp->c, (int)fresh, (int)delay);
 }
 
 
@@ -5071,6 +5813,10 @@ static int Receive_redraw(int ind)
         /* Break mind link */
         break_mind_link(p);
 
+        /* Resend the whole map and status */
+        line_shadow_reset(connp);
+        status_shadow_reset(connp);
+
         do_cmd_redraw(p);
     }
 
@@ -6295,6 +7041,7 @@ static int Enter_player(int ind)
     verify_panel(p);
 
     NumPlayers++;
+    chunk_roster_add(p);
 
     connp->id = NumConnections;
     set_player_index(connp, NumPlayers);
@@ -6509,6 +7256,19 @@ static int Receive_play(int ind)
             Destroy_connection(ind, "Cannot receive play packet");
             return -1;
         }
+
+        /* Does the client have our struct info already? */
+        if (connp->caps & CAPS_STRUCT_CACHE)
+        {
+            if ((n = Packet_scanf(&connp->r, "%b", &ch)) != 1)
+            {
+                errno = 0;
+                plog("Cannot receive play packet");
+                Destroy_connection(ind, "Cannot receive play packet");
+                return -1;
+            }
+            connp->struct_cached = (ch? true: false);
+        }
     }
 
     if (connp->state != CONN_SETUP)
@@ -6653,6 +7413,7 @@ static int Receive_play(int ind)
             return -1;
         }
 
+        traffic_mark(connp);
         if (Packet_printf(&connp->c, "%b%b", (unsigned)PKT_PLAY_SETUP, (unsigned)chardump) <= 0)
         {
             Destroy_connection(ind, "play_setup write error");
@@ -6666,17 +7427,7 @@ static int Receive_play(int ind)
     if (phase == 1)
     {
         Send_basic_info(ind);
-        Send_limits_struct_info(ind);
-        Send_kind_struct_info(ind);
-        Send_ego_struct_info(ind);
-        Send_race_struct_info(ind);
-        Send_realm_struct_info(ind);
-        Send_class_struct_info(ind);
-        Send_body_struct_info(ind);
-        Send_socials_struct_info(ind);
-        Send_rinfo_struct_info(ind);
-        Send_rbinfo_struct_info(ind);
-        Send_curse_struct_info(ind);
+        Send_struct_info(ind, 0);
 
         return 2;
     }
@@ -6684,7 +7435,7 @@ static int Receive_play(int ind)
     /* Send feat info */
     if (phase == 2)
     {
-        Send_feat_struct_info(ind);
+        Send_struct_info(ind, 1);
 
         return 2;
     }
@@ -6692,9 +7443,7 @@ static int Receive_play(int ind)
     /* Send struct info (part 2) */
     if (phase == 3)
     {
-        Send_trap_struct_info(ind);
-        Send_timed_struct_info(ind);
-        Send_abilities_struct_info(ind);
+        Send_struct_info(ind, 2);
         Send_char_info_conn(ind);
 
         return 2;
@@ -6774,7 +7523,8 @@ static int Receive_keepalive(int ind)
         if (n == -1) Destroy_connection(ind, "Keepalive read error");
         return n;
     }
-    Packet_printf(&connp->c, "%b%ld", (unsigned)PKT_KEEPALIVE, ctime);
+    traffic_mark(connp);
+    Packet_write_keepalive(&connp->c, ctime);
 
     return 2;
 }
@@ -6832,6 +7582,7 @@ static int sync_settings(struct player *p)
         verify_panel(p);
 
         /* Redraw map */
+        line_shadow_reset(connp);
         p->upkeep->redraw |= (PR_MAP);
     }
 
@@ -7395,6 +8146,7 @@ static int Receive_purchase(int ind)
             else
                 do_cmd_retrieve(p, item, amt);
 
+            traffic_mark(connp);
             Packet_printf(&connp->c, "%b", (unsigned)PKT_PURCHASE);
         }
         else
@@ -7514,6 +8266,7 @@ static int Receive_store_confirm(int ind)
         if (in_store(p))
         {
             store_confirm(p);
+            traffic_mark(connp);
             Packet_printf(&connp->c, "%b", (unsigned)PKT_STORE_CONFIRM);
         }
         else if (p->current_house != -1)
@@ -7795,6 +8548,19 @@ static const receive_handler_f playing_receive[] =
 };
 
 
+/*
+ * Count a packet executed from the command queue, which started at "start"
+ */
+static void traffic_in(connection_t *connp, int type, char *start)
+{
+    /* The connection is gone */
+    if (connp->state == CONN_FREE) return;
+
+    connp->traffic.pkts_in[type]++;
+    connp->traffic.bytes_in[type] += connp->r.ptr - start;
+}
+
+
 /* Actually execute commands from the client command queue */
 bool process_pending_commands(int ind)
 {
@@ -7802,6 +8568,7 @@ bool process_pending_commands(int ind)
     struct player *p;
     int type, result, old_energy = 0;
     const receive_handler_f *receive_tbl;
+    char *start;
 
     /* Hack to see if we have quit in this function */
     int num_players_start = NumPlayers;
@@ -7858,7 +8625,9 @@ bool process_pending_commands(int ind)
             /* Paranoia */
             if ((type < PKT_UNDEFINED) || (type >= PKT_MAX)) type = PKT_UNDEFINED;
             
+            start = connp->r.ptr;
             result = (*receive_tbl[type])(ind);
+            if (result > 0) traffic_in(connp, type, start);
             data_advance += ((int)connp->r.ptr - last_pos);
             ht_copy(&connp->start, &turn);
             if (result == 0) return true;
@@ -7893,7 +8662,9 @@ bool process_pending_commands(int ind)
                 p->firing_request = false;
         }
 
+        start = connp->r.ptr;
         result = (*receive_tbl[type])(ind);
+        if (result > 0) traffic_in(connp, type, start);
         if (connp->state == CONN_PLAYING) ht_copy(&connp->start, &turn);
         if (result == -1) return true;
 
@@ -8012,12 +8783,19 @@ int Net_output_p(struct player *p)
 {
     connection_t *connp = get_connection(p->conn);
 
+    /* Send the grids changed during this turn */
+    Send_queued_chars(p);
+
+    /* Send the status packets held back if the client has caught up */
+    status_shadow_flush(connp);
+
     /*
      * If we have any data to send to the client, terminate it
      * and send it to the client.
      */
     if (connp->c.len > 0)
     {
+        traffic_mark(connp);
         if (Packet_printf(&connp->c, "%b", (unsigned)PKT_END) <= 0)
         {
             Destroy_connection(p->conn, "Net output write error");
@@ -8026,6 +8804,13 @@ int Net_output_p(struct player *p)
         Send_reliable(p->conn);
     }
 
+    /* Keep draining the send queue while status packets are held back */
+    else if (connp->status.any_pending && Sockbuf_pending(&connp->w))
+        Send_reliable(p->conn);
+
+    /* Send the map rows to our spectators */
+    Flush_watchers(connp);
+
     return 1;
 }
 
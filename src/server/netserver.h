@@ -28,6 +28,94 @@
 #define LINK_DOMINANT   1
 #define LINK_DOMINATED  2
 
+/*
+ * Size of a row of map grids waiting to be sent
+ */
+#define SCR_DIRTY_SIZE  FLAG_SIZE(z_info->dungeon_wid + COL_MAP)
+
+/*
+ * Map rows as last received by the client, used to send only the grids that changed
+ */
+struct line_shadow
+{
+    cave_view_type  *scr;       /* Attr/char of each grid */
+    cave_view_type  *trn;       /* Transparency attr/char of each grid */
+    int16_t         *cols;      /* Width of each row, 0 if the client copy is unknown */
+    bool            graphics;   /* Transparency layer was part of the rows */
+};
+
+/*
+ * Status packets whose last copy sent is kept (one slot per stat for PKT_STAT)
+ */
+enum
+{
+    STATUS_LVL = 0,
+    STATUS_WEIGHT,
+    STATUS_PLUSSES,
+    STATUS_AC,
+    STATUS_EXP,
+    STATUS_GOLD,
+    STATUS_HP,
+    STATUS_SP,
+    STATUS_VARIOUS,
+    STATUS_TITLE,
+    STATUS_EXTRA,
+    STATUS_DEPTH,
+    STATUS_EFFECTS,
+    STATUS_RECALL,
+    STATUS_STATE,
+    STATUS_SPEED,
+    STATUS_STUDY,
+    STATUS_DTRAP,
+    STATUS_HEALTH,
+    STATUS_TURN,
+    STATUS_STAT,
+    STATUS_MAX = STATUS_STAT + STAT_MAX
+};
+
+/*
+ * Status packets as last sent to the client, used to drop the ones that didn't change
+ *
+ * While the client lags behind, they are held back instead ("pending") and only the latest
+ * of each is sent once the connection drains.
+ */
+struct status_shadow
+{
+    char            *data[STATUS_MAX];  /* Encoded packet */
+    int16_t         len[STATUS_MAX];    /* Length of the packet, 0 if none was sent yet */
+    bool            pending[STATUS_MAX];    /* Packet is waiting for the connection to drain */
+    bool            any_pending;        /* Some packet is waiting */
+    long            suppressed;         /* Number of packets dropped */
+    long            deferred;           /* Number of packets held back */
+};
+
+/*
+ * Traffic counters of a connection, dumped by the "traffic" console command
+ *
+ * Outgoing packets are counted as they are written to the reliable buffer "c": "mark" is where
+ * the last one started. Latency runs from the arrival of a command to the next time something is
+ * sent back.
+ */
+struct conn_traffic
+{
+    long            pkts_in[PKT_MAX];   /* Packets received, by type */
+    long            bytes_in[PKT_MAX];  /* Bytes received, by type */
+    long            pkts_out[PKT_MAX];  /* Packets sent, by type */
+    long            bytes_out[PKT_MAX]; /* Bytes sent, by type */
+    int             mark;               /* Start of the packet being written to "c" */
+    long            stalls;             /* Sends that left data queued in "w" */
+    int             max_c;              /* Deepest reliable buffer */
+    int             max_q;              /* Deepest command queue */
+    int             max_w;              /* Deepest send queue */
+    long long       pending;            /* Arrival of the oldest unanswered command (usec) */
+    long            replies;            /* Commands answered */
+    long long       latency;            /* Total command-to-response latency (usec) */
+    long            max_latency;        /* Worst command-to-response latency (usec) */
+    long            wire_in;            /* Bytes received on the socket (see Conn_get_traffic()) */
+    long            wire_out;           /* Bytes sent on the socket (see Conn_get_traffic()) */
+    long            blocked;            /* Reads and writes refused with EAGAIN (same) */
+};
+
 typedef struct
 {
     int             state;
@@ -42,10 +130,13 @@ typedef struct
     uint8_t            char_state;
     int             id;
     unsigned        version;
+    uint32_t            caps;
+    bool            struct_cached;
     char            *real;
     char            *nick;
     char            *addr;
     char            *host;
+    char            resolved[NORMAL_WID];
     char            *pass;
     uint8_t            ridx;
     uint8_t            cidx;
@@ -58,6 +149,12 @@ typedef struct
     uint8_t            console_channels[MAX_CHANNELS];
     uint32_t            account;
     char            *quit_msg;
+    struct line_shadow  shadow;
+    struct status_shadow    status;
+    struct conn_traffic traffic;
+    int             watching;       /* Connection watched by this spectator (-1 if none) */
+    int             next_watcher;   /* Next spectator of the same connection */
+    int             watchers;       /* First spectator of this connection (-1 if none) */
 } connection_t;
 
 struct birth_options
@@ -91,24 +188,13 @@ extern void Conn_set_console_setting(int ind, int set, bool val);
 extern bool Conn_get_console_setting(int ind, int set);
 extern int Init_setup(void);
 extern uint8_t *Conn_get_console_channels(int ind);
+extern bool Conn_watch(int ind, struct player *p);
+extern void Conn_get_traffic(int ind, struct conn_traffic *traffic);
+extern void Conn_get_traffic_total(struct conn_traffic *total);
 
 /*** Sending ***/
 extern int Send_basic_info(int ind);
-extern int Send_limits_struct_info(int ind);
-extern int Send_race_struct_info(int ind);
-extern int Send_class_struct_info(int ind);
-extern int Send_body_struct_info(int ind);
-extern int Send_socials_struct_info(int ind);
-extern int Send_kind_struct_info(int ind);
-extern int Send_ego_struct_info(int ind);
-extern int Send_rinfo_struct_info(int ind);
-extern int Send_rbinfo_struct_info(int ind);
-extern int Send_curse_struct_info(int ind);
-extern int Send_realm_struct_info(int ind);
-extern int Send_feat_struct_info(int ind);
-extern int Send_trap_struct_info(int ind);
-extern int Send_timed_struct_info(int ind);
-extern int Send_abilities_struct_info(int ind);
+extern int Send_struct_info(int ind, int phase);
 extern int Send_death_cause(struct player *p);
 extern int Send_winner(struct player *p);
 extern int Send_lvl(struct player *p, int lev, int mlev);
@@ -142,6 +228,8 @@ extern int Send_study(struct player *p, int study, bool can_study_book);
 extern int Send_count(struct player *p, uint8_t type, int16_t count);
 extern int Send_show_floor(struct player *p, uint8_t mode);
 extern int Send_char(struct player *p, struct loc *grid, uint16_t a, char c, uint16_t ta, char tc);
+extern void Queue_char(struct player *p, struct loc *grid);
+extern void Send_queued_chars(struct player *p);
 extern int Send_spell_info(struct player *p, int book, int i, const char *out_val,
     spell_flags *flags, int smana);
 extern int Send_book_info(struct player *p, int book, const char *name);
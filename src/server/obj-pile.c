@@ -1019,6 +1019,7 @@ bool floor_carry(struct player *p, struct chunk *c, struct loc *grid, struct obj
         {
             /* Combine the items */
             object_absorb(obj, drop);
+            floor_watch_timeout(c, obj);
 
             /* Note the pile */
             if (p && square_isview(p, grid)) square_note_spot(c, grid);
@@ -1057,6 +1058,7 @@ bool floor_carry(struct player *p, struct chunk *c, struct loc *grid, struct obj
 
     /* Link to the first object in the pile */
     pile_insert(&square(c, grid)->obj, drop);
+    floor_watch(c, drop);
 
     /* Redraw */
     square_note_spot(c, grid);
@@ -1094,12 +1096,97 @@ bool floor_add(struct chunk *c, struct loc *grid, struct object *drop)
 
     /* Link to the last object in the pile */
     pile_insert_end(&square(c, grid)->obj, drop);
+    floor_watch(c, drop);
 
     /* Result */
     return true;
 }
 
 
+static void floor_list_add(struct object ***list, int *num, int *size, struct object *obj)
+{
+    if (*num == *size)
+    {
+        *size = (*size? *size * 2: 16);
+        *list = mem_realloc(*list, *size * sizeof(struct object *));
+    }
+    (*list)[(*num)++] = obj;
+}
+
+
+static void floor_list_remove(struct object **list, int *num, struct object *obj)
+{
+    int i;
+
+    for (i = 0; i < *num; i++)
+    {
+        if (list[i] != obj) continue;
+
+        /* Order doesn't matter */
+        list[i] = list[--(*num)];
+        return;
+    }
+}
+
+
+/*
+ * Check if a floor object has a timeout running: recharging rods and decaying corpses
+ */
+static bool floor_timed(const struct object *obj)
+{
+    if (tval_can_have_timeout(obj)) return (obj->timeout > 0);
+    if (tval_is_corpse(obj)) return (obj->decay > 0);
+    return false;
+}
+
+
+/*
+ * Keep track of a new floor object if it needs processing every ten game turns: rods recharge,
+ * corpses decompose and multi-hued objects shimmer. This way process_objects() only looks at
+ * these objects instead of scanning the whole level.
+ */
+void floor_watch(struct chunk *c, struct object *obj)
+{
+    if (floor_timed(obj))
+        floor_list_add(&c->timed_objs, &c->timed_num, &c->timed_size, obj);
+    if (object_shimmer(obj))
+        floor_list_add(&c->shimmer_objs, &c->shimmer_num, &c->shimmer_size, obj);
+}
+
+
+/*
+ * Start or stop tracking a floor object whose timeout has just been set or has run out
+ */
+void floor_watch_timeout(struct chunk *c, struct object *obj)
+{
+    int i;
+
+    if (!c) return;
+
+    for (i = 0; i < c->timed_num; i++)
+    {
+        if (c->timed_objs[i] == obj) break;
+    }
+
+    if (floor_timed(obj) && (i == c->timed_num))
+        floor_list_add(&c->timed_objs, &c->timed_num, &c->timed_size, obj);
+    else if (!floor_timed(obj) && (i < c->timed_num))
+        c->timed_objs[i] = c->timed_objs[--c->timed_num];
+}
+
+
+/*
+ * Forget about an object leaving the floor
+ */
+void floor_unwatch(struct chunk *c, struct object *obj)
+{
+    if (tval_can_have_timeout(obj) || tval_is_corpse(obj))
+        floor_list_remove(c->timed_objs, &c->timed_num, obj);
+    if (object_shimmer(obj))
+        floor_list_remove(c->shimmer_objs, &c->shimmer_num, obj);
+}
+
+
 /*
  * Delete an object when the floor fails to carry it, and attempt to remove
  * it from the object list
@@ -60,6 +60,9 @@ extern struct object *floor_object_for_use(struct player *p, struct chunk *c,
 extern bool floor_carry(struct player *p, struct chunk *c, struct loc *grid, struct object *drop,
     bool *note);
 extern bool floor_add(struct chunk *c, struct loc *grid, struct object *drop);
+extern void floor_watch(struct chunk *c, struct object *obj);
+extern void floor_watch_timeout(struct chunk *c, struct object *obj);
+extern void floor_unwatch(struct chunk *c, struct object *obj);
 extern void drop_near(struct player *p, struct chunk *c, struct object **dropped, int chance,
     struct loc *grid, bool verbose, int mode, bool prefer_pile);
 extern void push_object(struct player *p, struct chunk *c, struct loc *grid);
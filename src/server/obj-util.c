@@ -908,23 +908,29 @@ void set_origin(struct object *obj, uint8_t origin, int16_t origin_depth,
 
 /*
  * Shimmer multi-hued objects
+ *
+ * Only the grids holding a shimmering object are checked, so a remembered object that is no
+ * longer there stops shimmering.
  */
 void shimmer_objects(struct player *p, struct chunk *c)
 {
-    struct loc begin, end;
-    struct loc_iterator iter;
-
-    loc_init(&begin, 1, 1);
-    loc_init(&end, c->width, c->height);
-    loc_iterator_first(&iter, &begin, &end);
+    int i, j;
 
     /* Shimmer multi-hued objects */
-    do
+    for (i = 0; i < c->shimmer_num; i++)
     {
+        struct loc *grid = &c->shimmer_objs[i]->grid;
         struct object *obj, *first_obj = NULL;
 
+        /* Check each grid once */
+        for (j = 0; j < i; j++)
+        {
+            if (loc_eq(&c->shimmer_objs[j]->grid, grid)) break;
+        }
+        if (j < i) continue;
+
         /* Need to be the first object on the pile that is not ignored */
-        for (obj = square_known_pile(p, c, &iter.cur); obj; obj = obj->next)
+        for (obj = square_known_pile(p, c, grid); obj; obj = obj->next)
         {
             if (!ignore_item_ok(p, obj))
             {
@@ -940,9 +946,8 @@ void shimmer_objects(struct player *p, struct chunk *c)
 
         /* Light that spot */
         if (first_obj && object_shimmer(first_obj))
-            square_light_spot_aux(p, c, &iter.cur);
+            square_light_spot_aux(p, c, grid);
     }
-    while (loc_iterator_next_strict(&iter));
 }
 
 
@@ -952,19 +957,16 @@ void shimmer_objects(struct player *p, struct chunk *c)
 void process_objects(struct chunk *c)
 {
     int i;
-    struct loc begin, end;
-    struct loc_iterator iter;
 
     /* Every 10 game turns */
     if ((turn.turn % 10) != 5) return;
 
-    /* Check everyone */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check everyone on the level */
+    for (i = 0; i < chunk_roster_num(c); i++)
     {
-        struct player *p = player_get(i);
+        struct player *p = chunk_roster_get(c, i);
 
         /* Skip irrelevant players */
-        if (!wpos_eq(&p->wpos, &c->wpos)) continue;
         if (p->upkeep->new_level_method || p->upkeep->funeral) continue;
         if (!allow_shimmer(p)) continue;
 
@@ -972,46 +974,41 @@ void process_objects(struct chunk *c)
         shimmer_objects(p, c);
     }
 
-    loc_init(&begin, 1, 1);
-    loc_init(&end, c->width, c->height);
-    loc_iterator_first(&iter, &begin, &end);
-
-    /* Recharge other level objects */
-    do
+    /*
+     * Recharge other level objects (backwards, since a deleted object is replaced by the last
+     * one of the list)
+     */
+    for (i = c->timed_num - 1; i >= 0; i--)
     {
-        struct object *obj, *next;
+        struct object *obj = c->timed_objs[i];
+        struct loc grid;
         bool redraw = false;
 
-        obj = square_object(c, &iter.cur);
+        loc_copy(&grid, &obj->grid);
 
-        while (obj)
+        /* Recharge rods, and stop watching them once fully charged */
+        if (tval_can_have_timeout(obj))
         {
-            next = obj->next;
-
-            /* Recharge rods */
-            if (tval_can_have_timeout(obj) && recharge_timeout(obj))
-                redraw = true;
-
-            /* Corpses slowly decompose */
-            if (tval_is_corpse(obj))
-            {
-                obj->decay--;
+            if (recharge_timeout(obj)) redraw = true;
+            if (!obj->timeout) floor_watch_timeout(c, obj);
+        }
 
-                /* Notice changes */
-                if (obj->decay == obj->timeout / 5)
-                    redraw = true;
+        /* Corpses slowly decompose */
+        if (tval_is_corpse(obj))
+        {
+            obj->decay--;
 
-                /* No more corpse... */
-                else if (!obj->decay)
-                    square_delete_object(c, &iter.cur, obj, false, false);
-            }
+            /* Notice changes */
+            if (obj->decay == obj->timeout / 5)
+                redraw = true;
 
-            obj = next;
+            /* No more corpse... */
+            else if (!obj->decay)
+                square_delete_object(c, &grid, obj, false, false);
         }
 
-        if (redraw) redraw_floor(&c->wpos, &iter.cur, NULL);
+        if (redraw) redraw_floor(&c->wpos, &grid, NULL);
     }
-    while (loc_iterator_next_strict(&iter));
 }
 
 
@@ -101,7 +101,13 @@ void dungeon_change_level(struct player *p, struct chunk *c, struct worldpos *ne
     set_energy(p, new_wpos);
 
     /* Set coordinates */
+    chunk_roster_remove(p);
     memcpy(&p->wpos, new_wpos, sizeof(struct worldpos));
+    chunk_roster_add(p);
+
+    /* Forget what was computed on the old level this turn */
+    ht_reset(&p->timefactor_turn);
+    ht_reset(&p->in_los_turn);
 
     /* One more player here */
     chunk_increase_player_count(new_wpos);
@@ -525,6 +525,9 @@ void init_player(struct player *p, int conn, bool old_history, bool no_recall)
         p->scr_info[i] = mem_zalloc((z_info->dungeon_wid + COL_MAP) * sizeof(cave_view_type));
         p->trn_info[i] = mem_zalloc((z_info->dungeon_wid + COL_MAP) * sizeof(cave_view_type));
     }
+    p->scr_dirty = mem_zalloc((z_info->dungeon_hgt + ROW_MAP + 1) * sizeof(bitflag*));
+    for (i = 0; i < z_info->dungeon_hgt + ROW_MAP + 1; i++)
+        p->scr_dirty[i] = mem_zalloc(SCR_DIRTY_SIZE * sizeof(bitflag));
 
     /* Allocate player sub-structs */
     p->upkeep = mem_zalloc(sizeof(struct player_upkeep));
@@ -699,6 +702,10 @@ void cleanup_player(struct player *p)
     p->scr_info = NULL;
     mem_free(p->trn_info);
     p->trn_info = NULL;
+    for (i = 0; p->scr_dirty && (i < z_info->dungeon_hgt + ROW_MAP + 1); i++)
+        mem_free(p->scr_dirty[i]);
+    mem_free(p->scr_dirty);
+    p->scr_dirty = NULL;
     for (i = 0; i < N_HISTORY_FLAGS; i++)
     {
         mem_free(p->hist_flags[i]);
@@ -196,13 +196,10 @@ static void project_feature_handler_DARK(project_feature_handler_context_t *cont
     /* Turn off the light */
     square_unglow(context->cave, &grid);
 
-    /* Check everyone */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check everyone on the level */
+    for (i = 0; i < chunk_roster_num(context->cave); i++)
     {
-        struct player *p = player_get(i);
-
-        /* If he's not here, skip him */
-        if (!wpos_eq(&p->wpos, &context->cave->wpos)) continue;
+        struct player *p = chunk_roster_get(context->cave, i);
 
         /* Hack -- forget "boring" grids */
         if (square_isview(p, &grid) && !square_isnormal(context->cave, &grid))
@@ -713,13 +710,10 @@ static void project_feature_handler_MAKE_TRAP(project_feature_handler_context_t
     {
         square_add_trap(context->cave, &grid);
 
-        /* Check everyone */
-        for (i = 1; i <= NumPlayers; i++)
+        /* Check everyone on the level */
+        for (i = 0; i < chunk_roster_num(context->cave); i++)
         {
-            struct player *p = player_get(i);
-
-            /* If he's not here, skip him */
-            if (!wpos_eq(&p->wpos, &context->cave->wpos)) continue;
+            struct player *p = chunk_roster_get(context->cave, i);
 
             square_reveal_trap(p, &grid, false, false);
         }
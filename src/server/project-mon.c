@@ -1449,6 +1449,7 @@ bool project_m_monster_attack_aux(struct monster *attacker, struct chunk *c, str
 
     /* Hurt the monster */
     mon->hp -= dam;
+    monster_note_wounded(c, mon);
 
     /* Dead monster */
     if (mon->hp < 0)
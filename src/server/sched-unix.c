@@ -20,10 +20,17 @@
 #define SERVER
 
 #define _POSIX_SOURCE
+#define _POSIX_C_SOURCE 200112L
 
 #include "s-angband.h"
 #include <signal.h>
 #include <sys/time.h>
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+#ifdef USE_TIMERFD
+#include <sys/timerfd.h>
+#endif
 
 #ifndef TRUE
 #define TRUE true
@@ -36,10 +43,6 @@ void core(const char* msg)
 {
     exit(-1);
 }
-void remove_timer_tick(void)
-{
-    //..
-}
 
 /*char sched_version[] = VERSION;*/
 
@@ -93,6 +96,105 @@ int sigprocmask(int how, const sigset_t *set, sigset_t *oset)
 #endif
 
 
+static volatile long	timer_ticks;	/* Ticks that have occurred */
+static long		timers_used;	/* Ticks that have been used */
+static long		timer_freq;	/* rate at which timer ticks. */
+static void		(*timer_handler)(void);
+static time_t		current_time;
+static int		ticks_till_second;
+
+/*
+ * Tick accounting: when the first tick after setup_timer() was due, and how
+ * late we have been at running the timer handler since.
+ */
+static struct timespec	timer_start;
+static long		timer_start_ticks;
+static struct timer_stats tick_stats;
+
+#ifdef USE_TIMERFD
+
+/*
+ * The game clock is a CLOCK_MONOTONIC timerfd which the scheduler waits on
+ * like any other input, so ticks no longer interrupt system calls and there
+ * is no signal mask to maintain.
+ */
+static int		timer_fd = -1;
+
+void block_timer(void)
+{
+    /* Nothing to block */
+}
+
+void allow_timer(void)
+{
+    /* Nothing to allow */
+}
+
+/*
+ * Read the number of expirations since the last read.
+ */
+static void catch_timer(int fd, int arg)
+{
+    uint64_t expirations;
+
+    if (read(fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+	timer_ticks += (long)expirations;
+    }
+}
+
+/*
+ * Create the timerfd if needed and (re)arm it.
+ */
+static void setup_timer(void)
+{
+    struct itimerspec its;
+    long long period;
+
+    if (timer_freq <= 0) {
+	plog(format("illegal timer frequency: %ld", timer_freq));
+	exit(1);
+    }
+
+    if (timer_fd == -1) {
+	timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+	if (timer_fd == -1) {
+	    plog(format("timerfd_create failed, errno = %d", errno));
+	    exit(1);
+	}
+	install_input(catch_timer, timer_fd, 0);
+    }
+
+    period = 1000000000LL / timer_freq;
+    its.it_interval.tv_sec = period / 1000000000LL;
+    its.it_interval.tv_nsec = period % 1000000000LL;
+    its.it_value = its.it_interval;
+    if (timerfd_settime(timer_fd, 0, &its, NULL) == -1) {
+	plog("timerfd_settime failed");
+	exit(1);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &timer_start);
+    timers_used = timer_start_ticks = timer_ticks;
+    time(&current_time);
+    ticks_till_second = timer_freq;
+}
+
+/*
+ * Stop the game clock.
+ */
+void remove_timer_tick(void)
+{
+    struct itimerspec its;
+
+    if (timer_fd == -1) {
+	return;
+    }
+    memset(&its, 0, sizeof(its));
+    timerfd_settime(timer_fd, 0, &its, NULL);
+}
+
+#else
+
 /*
  * Block or unblock a single signal.
  */
@@ -126,13 +228,6 @@ void allow_timer(void)
     sig_ok(SIGALRM, 1);
 }
 
-static volatile long	timer_ticks;	/* SIGALRMs that have occurred */
-static long		timers_used;	/* SIGALRMs that have been used */
-static long		timer_freq;	/* rate at which timer ticks. */
-static void		(*timer_handler)(void);
-static time_t		current_time;
-static int		ticks_till_second;
-
 /*
  * Catch SIGALRM.
  */
@@ -148,6 +243,7 @@ static void catch_timer(int signum)
 static void setup_timer(void)
 {
     struct itimerval itv;
+    long period;
     struct sigaction act;
 
     /*
@@ -174,15 +270,17 @@ static void setup_timer(void)
 	plog(format("illegal timer frequency: %ld", timer_freq));
 	exit(1);
     }
-    itv.it_interval.tv_sec = 0;
-    itv.it_interval.tv_usec = 1000000 / timer_freq;
+    period = 1000000L / timer_freq;
+    itv.it_interval.tv_sec = period / 1000000L;
+    itv.it_interval.tv_usec = period % 1000000L;
     itv.it_value = itv.it_interval;
     if (setitimer(ITIMER_REAL, &itv, NULL) == -1) {
 	plog("setitimer failed");
 	exit(1);
     }
 
-    timers_used = timer_ticks;
+    clock_gettime(CLOCK_MONOTONIC, &timer_start);
+    timers_used = timer_start_ticks = timer_ticks;
     time(&current_time);
     ticks_till_second = timer_freq;
 
@@ -192,6 +290,70 @@ static void setup_timer(void)
     allow_timer();
 }
 
+void remove_timer_tick(void)
+{
+    //..
+}
+
+#endif
+
+/*
+ * Nanoseconds elapsed between two monotonic timestamps.
+ */
+static long long timespec_diff(const struct timespec *from, const struct timespec *to)
+{
+    return (long long)(to->tv_sec - from->tv_sec) * 1000000000LL +
+	(to->tv_nsec - from->tv_nsec);
+}
+
+/*
+ * Run the timer handler for the oldest pending tick, recording how late it
+ * started and whether the frame took longer than one tick.
+ */
+static void run_timer_handler(void)
+{
+    struct timespec	now, done;
+    long long		period = 1000000000LL / timer_freq, late;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    late = timespec_diff(&timer_start, &now) - (timers_used + 1 - timer_start_ticks) * period;
+    if (late < 0) {
+	late = 0;
+    }
+
+    (*timer_handler)();
+
+    clock_gettime(CLOCK_MONOTONIC, &done);
+
+    tick_stats.frames++;
+    tick_stats.late_total += (long)(late / 1000);
+    if (late / 1000 > tick_stats.late_max) {
+	tick_stats.late_max = (long)(late / 1000);
+    }
+    if (timespec_diff(&now, &done) > period) {
+	tick_stats.overruns++;
+    }
+}
+
+/*
+ * Get the game clock statistics.
+ */
+void get_timer_stats(struct timer_stats *stats)
+{
+    memcpy(stats, &tick_stats, sizeof(*stats));
+}
+
+/*
+ * Microseconds elapsed on the monotonic clock, for measuring durations.
+ */
+long long get_clock_usec(void)
+{
+    struct timespec	now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
+
 /*
  * Configure timer tick callback.
  */
@@ -332,6 +494,94 @@ struct io_handler {
   
 static struct io_handler *input_handlers = NULL;
 static int              biggest_fd = -1;
+
+#ifdef USE_EPOLL
+
+/*
+ * epoll backend: the kernel keeps the interest list, so each wakeup only
+ * reports the descriptors that are actually ready instead of making us scan
+ * every descriptor up to max_fd. This also lifts the FD_SETSIZE limit.
+ *
+ * Descriptors are registered level-triggered: the input handlers (Contact,
+ * Handle_input, NewConsole...) consume a single read per call and rely on
+ * being called again while data remains, which edge-triggered mode would not
+ * guarantee.
+ */
+#define MAX_EPOLL_EVENTS	64
+
+static int		epoll_fd = -1;
+
+static void grow_handlers(int fd)
+{
+    int i;
+
+    if (fd <= biggest_fd) {
+	return;
+    }
+    input_handlers = realloc(input_handlers, sizeof(struct io_handler) * (fd + 1));
+    if (input_handlers == NULL) {
+	plog(format("input handler %d realloc failed", fd));
+	exit(1);
+    }
+    for (i = biggest_fd + 1; i <= fd; i++) {
+	input_handlers[i].func = 0;
+    }
+    biggest_fd = fd;
+}
+
+void install_input(void (*func)(int, int), int fd, int arg)
+{
+    struct epoll_event ev;
+
+    if (epoll_fd == -1) {
+	epoll_fd = epoll_create(MAX_EPOLL_EVENTS);
+	if (epoll_fd == -1) {
+	    plog(format("epoll_create failed, errno = %d", errno));
+	    exit(1);
+	}
+    }
+    if (fd < 0) {
+	plog(format("install illegal input handler fd %d", fd));
+	exit(1);
+    }
+    grow_handlers(fd);
+    if (input_handlers[fd].func) {
+	plog(format("input handler %d busy", fd));
+	exit(1);
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+	plog(format("epoll_ctl add %d failed, errno = %d", fd, errno));
+	exit(1);
+    }
+
+    input_handlers[fd].func = func;
+    input_handlers[fd].arg = arg;
+}
+
+void remove_input(int fd)
+{
+    struct epoll_event ev;
+
+    if (fd < 0) {
+	plog(format("remove illegal input handler fd %d", fd));
+	exit(1);
+    }
+    if (fd > biggest_fd || !input_handlers[fd].func) {
+	return;
+    }
+    input_handlers[fd].func = 0;
+
+    /* Pre-2.6.9 kernels want a non-NULL event even for EPOLL_CTL_DEL */
+    memset(&ev, 0, sizeof(ev));
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &ev);
+}
+
+#else
+
 static fd_set		input_mask;
 static int              input_mask_cleared = FALSE;
 static int		max_fd;
@@ -401,6 +651,8 @@ void remove_input(int fd)
     }
 }
 
+#endif
+
 static int		sched_running;
 
 void stop_sched(void)
@@ -408,16 +660,91 @@ void stop_sched(void)
     sched_running = 0;
 }
 
+/*
+ * Wait up to "tvp" for input and call the handlers of the ready descriptors.
+ * Returns the number of ready descriptors, 0 on timeout or interruption by
+ * the timer signal.
+ */
+#ifdef USE_EPOLL
+static int poll_input(struct timeval *tvp)
+{
+    struct epoll_event	events[MAX_EPOLL_EVENTS];
+    int			i, n, timeout = -1;
+
+    if (epoll_fd == -1) {
+	return 0;
+    }
+    if (tvp) {
+	timeout = tvp->tv_sec * 1000 + tvp->tv_usec / 1000;
+    }
+
+    n = epoll_wait(epoll_fd, events, MAX_EPOLL_EVENTS, timeout);
+    if (n < 0) {
+	if (errno != EINTR) {
+	    plog(format("Errno: %d\n", errno));
+	    core("sched epoll error");
+	    exit(1);
+	}
+	return 0;
+    }
+
+    for (i = 0; i < n; i++) {
+	int fd = events[i].data.fd;
+
+	/* A previous handler of this batch may have removed this one */
+	if (fd <= biggest_fd && input_handlers[fd].func) {
+	    (*input_handlers[fd].func)(fd, input_handlers[fd].arg);
+	}
+    }
+
+    return n;
+}
+#else
+static int poll_input(struct timeval *tvp)
+{
+    fd_set		readmask;
+    int			i, n, ready;
+
+/*
+ * KLJ -- Prevent crashes caused by "input_mask" changing during
+ * the "timeout_chime" function call (which happens when a player 
+ * dies).
+ */
+    readmask = input_mask;
+
+    n = select(max_fd, &readmask, 0, 0, tvp);
+    if (n < 0) {
+	if (errno != EINTR) {
+	    plog(format("Errno: %d\n",errno));
+	    core("sched select error");
+	    exit(1);
+	}
+	return 0;
+    }
+
+    ready = n;
+    for (i = max_fd; i >= 0; i--) {
+	if (FD_ISSET(i, &readmask)) {
+	    (*input_handlers[i].func)(i, input_handlers[i].arg);
+	    readmask = input_mask;
+	    if (--n == 0) {
+		break;
+	    }
+	}
+    }
+
+    return ready;
+}
+#endif
+
 /*
  * I/O + timer dispatcher.
  */
 void sched(void)
 {
     int			io_done = 0, io_todo = 3;
+    long		dropped;
     struct timeval	tv, *tvp = &tv;
-    fd_set              readmask;
-
-    readmask = input_mask;
 #ifdef VMS
     extern int NumPlayers, NumRobots, NumPseudoPlayers, NumQueuedPlayers;
     extern int login_in_progress;
@@ -456,53 +783,30 @@ void sched(void)
 	    tvp = &tv;
 
 	    if (timer_handler) {
-		(*timer_handler)();
+		run_timer_handler();
 	    }
 
+	    /* Consume the tick, dropping all but the last of any backlog */
+	    dropped = -1;
 	    do {
 		++timers_used;
+		++dropped;
 		if (--ticks_till_second <= 0) {
 		    ticks_till_second += timer_freq;
 		    current_time++;
 		    timeout_chime();
 		}
 	    } while (timers_used + 1 < timer_ticks);
+	    tick_stats.dropped += dropped;
 
 	}
 	else {
-            int n;
-
-/*
- * KLJ -- Prevent crashes caused by "input_mask" changing during
- * the "timeout_chime" function call (which happens when a player 
- * dies).
- */
-	    readmask = input_mask;
+	    int n = poll_input(tvp);
 
-	    n = select(max_fd, &readmask, 0, 0, tvp);
-	    if (n < 0) {
-		if (errno != EINTR) {
-                    plog(format("Errno: %d\n",errno));
-		    core("sched select error");
-		    exit(1);
-		}
-		io_todo = 0;
-	    }
-	    else if (n == 0) {
-                readmask = input_mask;
+	    if (n <= 0) {
 		io_todo = 0;
 	    }
 	    else {
-		int i;
-		for (i = max_fd; i >= 0; i--) {
-                    if (FD_ISSET(i,&readmask))  {
-			(*input_handlers[i].func)(i, input_handlers[i].arg);
-                        readmask = input_mask; 
-			if (--n == 0) {
-			    break;
-			}
-		    }
-		}
 		io_done++;
 		if (io_todo > 0) {
 		    io_todo--;
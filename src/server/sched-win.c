@@ -30,6 +30,7 @@ static time_t current_time;
 static int ticks_till_second;
 static DWORD resolution;
 static MMRESULT timer_id = 0;
+static struct timer_stats tick_stats;
 
 
 /*
@@ -358,10 +359,14 @@ void sched(void)
             io_todo = 3;
 
             (*timer_handler)();
+            tick_stats.frames++;
 
+            /* Consume the tick, dropping any backlog */
+            tick_stats.dropped--;
             do
             {
                 ++frame_count;
+                tick_stats.dropped++;
                 if (--ticks_till_second <= 0)
                 {
                     ticks_till_second += timer_freq;
@@ -427,3 +432,28 @@ void remove_timer_tick(void)
     if (timer_id != 0) stop_timer();
     timer_handler = null_timer_handler;
 }
+
+
+/*
+ * Get the game clock statistics (lateness is not measured here).
+ */
+void get_timer_stats(struct timer_stats *stats)
+{
+    memcpy(stats, &tick_stats, sizeof(*stats));
+}
+
+
+/*
+ * Microseconds elapsed on the performance counter, for measuring durations.
+ */
+long long get_clock_usec(void)
+{
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+
+    return (long long)(now.QuadPart / freq.QuadPart) * 1000000LL +
+        (long long)(now.QuadPart % freq.QuadPart) * 1000000LL / freq.QuadPart;
+}
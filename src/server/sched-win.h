@@ -6,11 +6,25 @@
 #ifndef SCHED_WIN_H
 #define SCHED_WIN_H
 
+/*
+ * Game clock statistics
+ */
+struct timer_stats
+{
+    long frames;        /* Frames run */
+    long overruns;      /* Frames that took longer than one tick */
+    long dropped;       /* Ticks skipped to catch up */
+    long late_max;      /* Worst delay between a tick and its frame (usec) */
+    long late_total;    /* Cumulated delay (usec) */
+};
+
 extern void install_timer_tick(void (*func)(void), int freq);
 extern void install_input(void (*func)(int, int), int fd, int arg);
 extern void remove_input(int fd);
 extern void sched(void);
 extern void free_input(void);
 extern void remove_timer_tick(void);
+extern void get_timer_stats(struct timer_stats *stats);
+extern long long get_clock_usec(void);
 
 #endif /* SCHED_WIN_H */
@@ -1622,6 +1622,7 @@ void free_wild_info(void)
 {
     int i;
     struct loc grid;
+    struct chunk *c;
 
     for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
     {
@@ -1635,9 +1636,10 @@ void free_wild_info(void)
                 if (!w_ptr->chunk_list[i]) continue;
 
                 /* Deallocate the level */
-                wipe_mon_list(w_ptr->chunk_list[i]);
-                cave_free(w_ptr->chunk_list[i]);
-                w_ptr->chunk_list[i] = NULL;
+                c = w_ptr->chunk_list[i];
+                chunk_list_remove(c);
+                wipe_mon_list(c);
+                cave_free(c);
             }
 
             mem_free(w_ptr->chunk_list);
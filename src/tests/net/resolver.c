@@ -0,0 +1,143 @@
+/*
+ * File: resolver.c
+ * Purpose: Check that reverse name lookups never block the game
+ *
+ * Copyright (c) 2025 MAngband and PWMAngband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "common/angband.h"
+#include <sys/time.h>
+
+
+#define STUB_NAME   "stub.example"
+
+
+/*
+ * Stub resolvers, run by the helper process instead of gethostbyaddr()
+ */
+static int resolver_stall(struct in_addr addr, char *name, int namelen)
+{
+    /* A nameserver that never answers */
+    while (true) pause();
+
+    return -1;
+}
+
+
+static int resolver_stub(struct in_addr addr, char *name, int namelen)
+{
+    my_strcpy(name, STUB_NAME, namelen);
+    return 0;
+}
+
+
+static long elapsed_msec(struct timeval *start)
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+    return (now.tv_sec - start->tv_sec) * 1000L + (now.tv_usec - start->tv_usec) / 1000L;
+}
+
+
+static int fail(const char *msg)
+{
+    fprintf(stderr, "resolver: %s\n", msg);
+    return 1;
+}
+
+
+/*
+ * Accept connections from localhost while the helper is stuck in a lookup
+ */
+static int test_stalled(void)
+{
+    int listen_fd, port, i;
+    char name[NORMAL_WID];
+    struct timeval start;
+
+    sl_resolver = resolver_stall;
+    if (SLResolverInit() == -1) return fail("cannot start the helper");
+
+    listen_fd = CreateServerSocket(0);
+    if (listen_fd == -1) return fail("cannot create the server socket");
+    port = GetPortNum(listen_fd);
+
+    gettimeofday(&start, NULL);
+    for (i = 0; i < 3; i++)
+    {
+        int client_fd = CreateClientSocket("127.0.0.1", port), fd;
+        struct sockaddr_in peer;
+        socklen_t len = sizeof(peer);
+
+        if (client_fd == -1) return fail("cannot connect");
+        fd = SocketAccept(listen_fd);
+        if (fd == -1) return fail("cannot accept");
+        if (getpeername(fd, (struct sockaddr *)&peer, &len) == -1) return fail("no peer");
+
+        /* The first lookup is stuck in the helper, the others queue behind it */
+        SLLookupName(peer.sin_addr, name, sizeof(name));
+        if (!streq(name, "127.0.0.1")) return fail("expected the dotted address");
+
+        SocketClose(fd);
+        SocketClose(client_fd);
+    }
+    if (elapsed_msec(&start) > 1000) return fail("the accept path was blocked");
+
+    SocketClose(listen_fd);
+    SLResolverClose();
+
+    return 0;
+}
+
+
+/*
+ * Get the hostname once the helper has answered, then from the cache
+ */
+static int test_answered(void)
+{
+    struct in_addr addr;
+    char name[NORMAL_WID];
+    int i;
+
+    sl_resolver = resolver_stub;
+    if (SLResolverInit() == -1) return fail("cannot start the helper");
+
+    addr.s_addr = inet_addr("127.0.0.1");
+    if (SLLookupName(addr, name, sizeof(name))) return fail("answered before asking");
+    if (!streq(name, "127.0.0.1")) return fail("expected the dotted address");
+
+    for (i = 0; i < 200; i++)
+    {
+        if (SLLookupName(addr, name, sizeof(name))) break;
+        Sleep(10);
+    }
+    if (!streq(name, STUB_NAME)) return fail("the helper never answered");
+
+    SLResolverClose();
+
+    return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+    /* Fail instead of hanging if anything blocks */
+    alarm(10);
+
+    if (test_stalled() || test_answered()) return 1;
+
+    printf("resolver: ok\n");
+    return 0;
+}